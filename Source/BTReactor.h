@@ -0,0 +1,831 @@
+//***************************************************************************************
+//
+//	Date Created:	October 17, 2026
+//	File:			BTReactor.h
+//	Project:		Blue Tetris
+//
+//	Purpose:		Event loop for the Blue Tetris server. Services the listening
+//					socket and every client socket from a single thread using
+//					non-blocking sockets; epoll is used on Linux and select elsewhere.
+//					The thread sleeps in the kernel until a socket has work or
+//					another thread posts output through a lock-free ring.
+//
+//***************************************************************************************
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <atomic>
+#include <thread>
+#include <string.h>
+#include "resource.h"
+#include "ringbuffer.h"
+#include "frame.h"
+using std::string;
+using std::vector;
+using std::pair;
+using std::atomic;
+
+#ifdef _WIN32
+#include <winsock2.h>
+#pragma comment(lib, "ws2_32.lib")
+typedef int socklen_t;
+#else
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+typedef int SOCKET;
+#define INVALID_SOCKET		-1
+#define SOCKET_ERROR		-1
+#define closesocket			::close
+#endif
+
+#ifdef __linux__
+#define BT_EPOLL
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#endif
+
+#ifdef MSG_NOSIGNAL
+#define REACTOR_SENDFLAGS	MSG_NOSIGNAL	// Report closed peers as errors, not signals
+#else
+#define REACTOR_SENDFLAGS	0
+#endif
+
+#define REACTOR_MAXEVENTS	64				// Events collected per wait
+#define REACTOR_READSIZE	4096			// Bytes taken from a socket per read
+#define REACTOR_POSTSIZE	4096			// Capacity of the posted output ring
+#define REACTOR_LISTENER	0xFFFFFFFF		// Event tag of the listening socket
+#define REACTOR_WAKE		0xFFFFFFFE		// Event tag of the wake descriptor
+#define REACTOR_SLOTBITS	20				// Connection id: slot in low bits,
+#define REACTOR_SLOTMASK	0xFFFFF			// reuse count of the slot above them
+
+//***************************************************************************************
+//
+//	Class:		cReactorHandler
+//	Purpose:	Receives connection events from cReactor. All functions are called
+//				on the reactor's thread. A received frame points into the reactor's
+//				input buffer and is only valid during the call.
+//
+//***************************************************************************************
+class cReactorHandler
+{
+public:
+	virtual void connected(int /*conn*/) {}						// New client accepted
+	virtual void received(int /*conn*/, const cFrame & /*frame*/) {}	// Complete frame read
+	virtual void disconnected(int /*conn*/) {}					// Client closed or dropped
+	virtual void idle() {}							// Called after each batch of events
+};
+
+//***************************************************************************************
+//
+//	Class:		cReactorConnection
+//	Purpose:	State of one client slot owned by cReactor
+//
+//***************************************************************************************
+class cReactorConnection
+{
+public:
+	cReactorConnection(): mSocket(INVALID_SOCKET), mHandle(-1), mOpen(false),
+		mQueued(false), mWatching(false) {}
+
+	SOCKET mSocket;								// Client socket
+	int mHandle;								// Connection id given to handler
+	string mInput;								// Partial frame awaiting its remainder
+	string mOutput;								// Bytes accepted but not yet written
+	bool mOpen;									// Flags slot in use
+	bool mQueued;								// Listed for the end of pass flush
+	bool mWatching;								// Waiting for socket to become writable
+};
+
+//***************************************************************************************
+//
+//	Class:		cReactor
+//	Purpose:	Accepts clients on a port, splits their byte streams into messages
+//				and writes queued output without blocking. Connection ids change
+//				whenever a slot is reused, so output posted for a client that has
+//				since disconnected is dropped rather than delivered to a newcomer.
+//
+//***************************************************************************************
+class cReactor
+{
+public:
+	cReactor();									// Constructor
+	~cReactor() { shutdown(); }					// Destructor
+
+	bool open(unsigned short port);				// Binds and listens on given port
+	void run(cReactorHandler* handler);			// Services sockets until stopped
+	void stop();								// Ends run(); safe from any thread
+	void shutdown();							// Closes all sockets
+
+	void send(int conn, const char* data, int length);	// Queues bytes for this pass
+	void post(int conn, const string &data);	// Sends bytes; safe from any thread
+	void close(int conn);						// Closes a client connection
+
+	bool connected(int conn);					// True if connection is open
+
+	void drainPosted();							// Sends posted output; reactor thread only
+
+private:
+
+	cReactorConnection* find(int conn);			// Returns open connection or NULL
+
+	void acceptClients();						// Accepts all pending clients
+	void readClient(int conn);					// Reads and frames client input
+	void writeClient(int conn);					// Writes queued client output
+	void watchOutput(cReactorConnection &client, bool state);	// Toggles writability
+	void flushOutput();							// Writes output gathered this pass
+
+	void wake();								// Interrupts wait; async-signal-safe
+
+	bool setNonBlocking(SOCKET socket);			// Sets socket to non-blocking mode
+	bool wouldBlock();							// True if last call would have blocked
+
+	vector<cReactorConnection> mConnections;	// Client slots
+	cReactorHandler* mHandler;					// Receiver of connection events
+	SOCKET mListener;							// Listening socket
+	atomic<bool> mStopping;						// Flags request to end run(); lock-free
+
+	cMPSCRing<pair<int, string> > mPosted;		// Output posted by other threads
+	atomic<bool> mWakePending;					// Wake sent and not yet drained
+	vector<int> mFlush;							// Connections with output this pass
+
+#ifdef BT_EPOLL
+	int mPoll;									// epoll instance
+	int mWake;									// eventfd signalled by wake()
+#else
+	SOCKET mWake[2];							// Wake channel: read end, write end
+#endif
+};
+
+//***************************************************************************************
+//
+//	Function:	constructor
+//	Purpose:	Initializes member data
+//
+//***************************************************************************************
+cReactor::cReactor(): mHandler(NULL), mListener(INVALID_SOCKET), mStopping(false),
+	mPosted(REACTOR_POSTSIZE), mWakePending(false)
+{
+#ifdef BT_EPOLL
+	mPoll = -1;
+	mWake = -1;
+#else
+	mWake[0] = mWake[1] = INVALID_SOCKET;
+#endif
+}
+
+//***************************************************************************************
+//
+//	Function:	open
+//	Purpose:	Creates the listening socket and the wake channel
+//	Return:		True if error occurs
+//
+//***************************************************************************************
+bool cReactor::open(unsigned short port)
+{
+	bool error(false);
+	sockaddr_in local;
+	int reuse(1);
+
+#ifdef _WIN32
+	WSADATA wsaData;
+	if(WSAStartup(0x202, &wsaData) != 0)
+		return true;
+#endif
+
+	mStopping = false;
+
+	memset(&local, 0, sizeof(local));
+	local.sin_family = AF_INET;
+	local.sin_addr.s_addr = INADDR_ANY;
+	local.sin_port = htons(port);
+
+	mListener = socket(AF_INET, SOCK_STREAM, 0);
+
+	if(mListener == INVALID_SOCKET)
+		error = true;
+
+	if(!error)
+	{
+		setsockopt(mListener, SOL_SOCKET, SO_REUSEADDR, (const char*)&reuse, sizeof(reuse));
+
+		error = bind(mListener, (sockaddr*)&local, sizeof(local)) != 0
+			 || listen(mListener, SOMAXCONN) != 0
+			 || setNonBlocking(mListener);
+	}
+
+#ifdef BT_EPOLL
+	if(!error)
+	{
+		epoll_event event;
+
+		mPoll = epoll_create1(EPOLL_CLOEXEC);
+		mWake = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+		error = (mPoll < 0 || mWake < 0);
+
+		if(!error)
+		{
+			event.events = EPOLLIN;
+			event.data.u32 = REACTOR_LISTENER;
+			error = epoll_ctl(mPoll, EPOLL_CTL_ADD, mListener, &event) != 0;
+
+			event.data.u32 = REACTOR_WAKE;
+			error = error || epoll_ctl(mPoll, EPOLL_CTL_ADD, mWake, &event) != 0;
+		}
+	}
+#elif defined(_WIN32)
+	if(!error)									// Loopback datagram socket sent to itself
+	{
+		sockaddr_in loopback;
+		socklen_t length = sizeof(loopback);
+
+		memset(&loopback, 0, sizeof(loopback));
+		loopback.sin_family = AF_INET;
+		loopback.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+		mWake[0] = mWake[1] = socket(AF_INET, SOCK_DGRAM, 0);
+		error = mWake[0] == INVALID_SOCKET
+			 || bind(mWake[0], (sockaddr*)&loopback, sizeof(loopback)) != 0
+			 || getsockname(mWake[0], (sockaddr*)&loopback, &length) != 0
+			 || connect(mWake[0], (sockaddr*)&loopback, sizeof(loopback)) != 0
+			 || setNonBlocking(mWake[0]);
+	}
+#else
+	if(!error)
+		error = pipe(mWake) != 0 || setNonBlocking(mWake[0]) || setNonBlocking(mWake[1]);
+#endif
+
+	if(error)
+		shutdown();
+
+	return error;
+}
+
+//***************************************************************************************
+//
+//	Function:	run
+//	Purpose:	Waits for socket activity and dispatches it to the handler until
+//				stop() is called
+//
+//***************************************************************************************
+void cReactor::run(cReactorHandler* handler)
+{
+	mHandler = handler;
+
+#ifdef BT_EPOLL
+	epoll_event events[REACTOR_MAXEVENTS];
+	int count;
+	int i;
+
+	while(!mStopping)
+	{
+		count = epoll_wait(mPoll, events, REACTOR_MAXEVENTS, -1);	// Sleep until activity
+
+		for(i = 0; i < count && !mStopping; i++)
+		{
+			unsigned int tag = events[i].data.u32;
+
+			if(tag == REACTOR_LISTENER)
+				acceptClients();
+			else if(tag == REACTOR_WAKE)
+				drainPosted();
+			else
+			{
+				if(events[i].events & EPOLLOUT)
+					writeClient(tag);
+				if(events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+					readClient(tag);
+			}
+		}
+
+		flushOutput();
+
+		if(!mStopping)
+			mHandler->idle();
+	}
+#else
+	fd_set readSet;
+	fd_set writeSet;
+	SOCKET highest;
+	int slot;
+
+	while(!mStopping)
+	{
+		FD_ZERO(&readSet);
+		FD_ZERO(&writeSet);
+		FD_SET(mListener, &readSet);
+		FD_SET(mWake[0], &readSet);
+		highest = mListener > mWake[0] ? mListener : mWake[0];
+
+		for(slot = 0; slot < (int)mConnections.size(); slot++)
+		{
+			cReactorConnection &client = mConnections[slot];
+
+			if(client.mOpen)
+			{
+				FD_SET(client.mSocket, &readSet);
+				if(!client.mOutput.empty())
+					FD_SET(client.mSocket, &writeSet);
+				if(client.mSocket > highest)
+					highest = client.mSocket;
+			}
+		}
+
+		if(select((int)highest + 1, &readSet, &writeSet, NULL, NULL) == SOCKET_ERROR)
+			continue;								// Interrupted
+
+		if(!mStopping && FD_ISSET(mWake[0], &readSet))
+			drainPosted();
+
+		if(!mStopping && FD_ISSET(mListener, &readSet))
+			acceptClients();
+
+		for(slot = 0; slot < (int)mConnections.size() && !mStopping; slot++)
+		{
+			cReactorConnection &client = mConnections[slot];
+			int conn = client.mHandle;
+
+			if(client.mOpen && FD_ISSET(client.mSocket, &writeSet))
+				writeClient(conn);
+			if(connected(conn) && FD_ISSET(client.mSocket, &readSet))
+				readClient(conn);
+		}
+
+		flushOutput();
+
+		if(!mStopping)
+			mHandler->idle();
+	}
+#endif
+
+	mHandler = NULL;
+}
+
+//***************************************************************************************
+//
+//	Function:	stop
+//	Purpose:	Requests that run() return; wakes the reactor if it is waiting.
+//				Only async-signal-safe calls are made on POSIX systems.
+//
+//***************************************************************************************
+void cReactor::stop()
+{
+	mStopping = true;
+	wake();
+}
+
+//***************************************************************************************
+//
+//	Function:	shutdown
+//	Purpose:	Closes every client socket, the listener and the wake channel
+//
+//***************************************************************************************
+void cReactor::shutdown()
+{
+	for(int slot(0); slot < (int)mConnections.size(); slot++)
+	{
+		if(mConnections[slot].mOpen)
+		{
+			closesocket(mConnections[slot].mSocket);
+			mConnections[slot].mOpen = false;
+		}
+	}
+	mConnections.clear();
+	mFlush.clear();
+
+	if(mListener != INVALID_SOCKET)
+	{
+		closesocket(mListener);
+		mListener = INVALID_SOCKET;
+	}
+
+	drainPosted();								// Release undelivered output
+
+#ifdef BT_EPOLL
+	if(mPoll >= 0)
+		::close(mPoll);
+	if(mWake >= 0)
+		::close(mWake);
+	mPoll = mWake = -1;
+#else
+	if(mWake[0] != INVALID_SOCKET)
+		closesocket(mWake[0]);
+	if(mWake[1] != INVALID_SOCKET && mWake[1] != mWake[0])
+		closesocket(mWake[1]);
+	mWake[0] = mWake[1] = INVALID_SOCKET;
+#endif
+}
+
+//***************************************************************************************
+//
+//	Function:	send
+//	Purpose:	Queues bytes for a client. Everything queued for a client during
+//				one pass of the event loop goes out in a single write at the end of
+//				the pass; a client whose socket is full gets it once writable.
+//				Reactor thread only.
+//
+//***************************************************************************************
+void cReactor::send(int conn, const char* data, int length)
+{
+	cReactorConnection* client = find(conn);
+
+	if(!client || length <= 0)
+		return;
+
+	client->mOutput.append(data, length);
+
+	if(!client->mQueued && !client->mWatching)
+	{
+		client->mQueued = true;
+		mFlush.push_back(conn);
+	}
+}
+
+//***************************************************************************************
+//
+//	Function:	post
+//	Purpose:	Queues bytes for a client from any thread. The reactor is woken
+//				only if no wake is already pending, so a burst costs one wake.
+//				While the ring is full the caller waits for the reactor to drain
+//				it; output posted once the reactor is stopping is dropped.
+//
+//***************************************************************************************
+void cReactor::post(int conn, const string &data)
+{
+	pair<int, string> item(conn, data);
+
+	while(mPosted.tryPush(item))
+	{
+		if(mStopping)
+			return;
+
+		if(!mWakePending.exchange(true))
+			wake();
+		std::this_thread::yield();
+	}
+
+	if(!mWakePending.exchange(true))
+		wake();
+}
+
+//***************************************************************************************
+//
+//	Function:	close
+//	Purpose:	Closes client connection and notifies the handler
+//
+//***************************************************************************************
+void cReactor::close(int conn)
+{
+	cReactorConnection* client = find(conn);
+
+	if(!client)
+		return;
+
+	closesocket(client->mSocket);				// Also removes socket from epoll set
+	client->mSocket = INVALID_SOCKET;
+	client->mOpen = false;
+	client->mInput.clear();
+	client->mOutput.clear();
+
+	if(mHandler)
+		mHandler->disconnected(conn);
+}
+
+//***************************************************************************************
+//
+//	Function:	connected
+//	Purpose:	Checks whether connection id refers to an open client
+//	Return:		True if connection is open
+//
+//***************************************************************************************
+bool cReactor::connected(int conn)
+{
+	return find(conn) != NULL;
+}
+
+//***************************************************************************************
+//
+//	Function:	find
+//	Purpose:	Looks up slot of connection id
+//	Return:		Connection, or NULL if the id is closed or stale
+//
+//***************************************************************************************
+cReactorConnection* cReactor::find(int conn)
+{
+	int slot = conn & REACTOR_SLOTMASK;
+
+	if(conn < 0 || slot >= (int)mConnections.size())
+		return NULL;
+
+	cReactorConnection &client = mConnections[slot];
+
+	if(!client.mOpen || client.mHandle != conn)
+		return NULL;
+
+	return &client;
+}
+
+//***************************************************************************************
+//
+//	Function:	acceptClients
+//	Purpose:	Accepts every pending client, assigns each a connection slot
+//
+//***************************************************************************************
+void cReactor::acceptClients()
+{
+	int noDelay(1);								// Output is already coalesced per pass
+	SOCKET socket;
+	sockaddr_in from;
+	socklen_t fromlen;
+	int slot;
+	int reuse;
+
+	while(!mStopping)
+	{
+		fromlen = sizeof(from);
+		socket = accept(mListener, (sockaddr*)&from, &fromlen);
+
+		if(socket == INVALID_SOCKET)				// No more pending clients
+			break;
+
+		for(slot = 0; slot < (int)mConnections.size() && mConnections[slot].mOpen; slot++)
+		{}											// Find free slot
+
+		if(slot > REACTOR_SLOTMASK || setNonBlocking(socket))
+		{
+			closesocket(socket);
+			continue;
+		}
+
+		if(slot == (int)mConnections.size())
+			mConnections.push_back(cReactorConnection());
+
+		cReactorConnection &client = mConnections[slot];
+		reuse = (client.mHandle < 0) ? 0 : ((client.mHandle >> REACTOR_SLOTBITS) + 1) & 0x3FF;
+
+		client.mSocket = socket;
+		client.mHandle = slot | (reuse << REACTOR_SLOTBITS);
+		client.mOpen = true;
+		client.mQueued = false;
+		client.mWatching = false;
+
+		setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, (const char*)&noDelay, sizeof(noDelay));
+
+#ifdef BT_EPOLL
+		epoll_event event;
+		event.events = EPOLLIN;
+		event.data.u32 = client.mHandle;
+		if(epoll_ctl(mPoll, EPOLL_CTL_ADD, socket, &event) != 0)
+		{
+			closesocket(socket);
+			client.mOpen = false;
+			continue;
+		}
+#endif
+
+		mHandler->connected(client.mHandle);
+	}
+}
+
+//***************************************************************************************
+//
+//	Function:	readClient
+//	Purpose:	Reads available bytes from client and hands each complete frame to
+//				the handler. Frames are parsed where they lie: in the read buffer
+//				itself unless a partial frame was left over from the last read.
+//				A client sending anything but a valid frame is dropped.
+//
+//***************************************************************************************
+void cReactor::readClient(int conn)
+{
+	cReactorConnection* client = find(conn);
+	char buff[REACTOR_READSIZE];
+	const char* data;							// Bytes being parsed
+	int length;									// Number of bytes being parsed
+	int used(0);								// Bytes consumed by complete frames
+	int size;									// Size of current frame
+	cFrame frame;
+	int r;
+
+	if(!client)
+		return;
+
+	r = recv(client->mSocket, buff, REACTOR_READSIZE, 0);
+
+	if(r == 0 || (r == SOCKET_ERROR && !wouldBlock()))	// Closed or failed
+	{
+		close(conn);
+		return;
+	}
+
+	if(r == SOCKET_ERROR)						// Nothing to read after all
+		return;
+
+	if(client->mInput.empty())					// Parse straight from read buffer
+	{
+		data = buff;
+		length = r;
+	}
+	else										// Complete the partial frame first
+	{
+		client->mInput.append(buff, r);
+		data = client->mInput.data();
+		length = (int)client->mInput.length();
+	}
+
+	while((size = frame.parse(data + used, length - used)) > 0)
+	{
+		used += size;
+		mHandler->received(conn, frame);
+
+		if(!(client = find(conn)))				// Handler closed connection
+			return;
+	}
+
+	if(size == FRAME_MALFORMED)
+	{
+		close(conn);
+		return;
+	}
+
+	if(data == buff)							// Keep partial frame for next read
+		client->mInput.assign(buff + used, r - used);
+	else
+		client->mInput.erase(0, used);
+}
+
+//***************************************************************************************
+//
+//	Function:	writeClient
+//	Purpose:	Writes as much queued output as the client socket will accept
+//
+//***************************************************************************************
+void cReactor::writeClient(int conn)
+{
+	cReactorConnection* client = find(conn);
+
+	if(!client || client->mOutput.empty())
+		return;
+
+	int r = ::send(client->mSocket, client->mOutput.data(), (int)client->mOutput.length(),
+				   REACTOR_SENDFLAGS);
+
+	if(r == SOCKET_ERROR)
+	{
+		if(!wouldBlock())
+			close(conn);
+		else
+			watchOutput(*client, true);
+	}
+	else
+	{
+		client->mOutput.erase(0, r);
+		watchOutput(*client, !client->mOutput.empty());
+	}
+}
+
+//***************************************************************************************
+//
+//	Function:	watchOutput
+//	Purpose:	Adds or removes writability from the events reported for client.
+//				select builds its sets from queued output each pass instead.
+//
+//***************************************************************************************
+void cReactor::watchOutput(cReactorConnection &client, bool state)
+{
+	if(client.mWatching == state)
+		return;
+
+	client.mWatching = state;
+
+#ifdef BT_EPOLL
+	epoll_event event;
+	event.events = state ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+	event.data.u32 = client.mHandle;
+	epoll_ctl(mPoll, EPOLL_CTL_MOD, client.mSocket, &event);
+#endif
+}
+
+//***************************************************************************************
+//
+//	Function:	flushOutput
+//	Purpose:	Writes the output gathered for each client during this pass, one
+//				write per client
+//
+//***************************************************************************************
+void cReactor::flushOutput()
+{
+	cReactorConnection* client;
+
+	for(unsigned int i(0); i < mFlush.size(); i++)
+	{
+		if((client = find(mFlush[i])))
+		{
+			client->mQueued = false;
+			writeClient(mFlush[i]);
+		}
+	}
+
+	mFlush.clear();
+}
+
+//***************************************************************************************
+//
+//	Function:	wake
+//	Purpose:	Makes the wake channel readable so a waiting run() returns from the
+//				kernel. Only async-signal-safe calls are made on POSIX systems.
+//
+//***************************************************************************************
+void cReactor::wake()
+{
+	int r(0);
+
+#ifdef BT_EPOLL
+	unsigned long long one(1);
+	if(mWake >= 0)
+		r = write(mWake, &one, sizeof(one));
+#elif defined(_WIN32)
+	char one(1);
+	if(mWake[1] != INVALID_SOCKET)
+		r = ::send(mWake[1], &one, 1, 0);
+#else
+	char one(1);
+	if(mWake[1] != INVALID_SOCKET)
+		r = write(mWake[1], &one, 1);
+#endif
+
+	(void)r;									// A full channel is already readable
+}
+
+//***************************************************************************************
+//
+//	Function:	drainPosted
+//	Purpose:	Resets the wake channel and sends output posted by other threads.
+//				The pending flag is cleared before the ring is read, so anything
+//				posted after the last read raises a fresh wake.
+//
+//***************************************************************************************
+void cReactor::drainPosted()
+{
+	pair<int, string> posted;
+
+#ifdef BT_EPOLL
+	unsigned long long count;
+	while(read(mWake, &count, sizeof(count)) > 0)
+	{}
+#elif defined(_WIN32)
+	char buff[64];
+	while(recv(mWake[0], buff, sizeof(buff), 0) > 0)
+	{}
+#else
+	char buff[64];
+	while(read(mWake[0], buff, sizeof(buff)) > 0)
+	{}
+#endif
+
+	mWakePending.exchange(false);
+
+	while(!mPosted.tryPop(posted))
+		send(posted.first, posted.second.data(), (int)posted.second.length());
+}
+
+//***************************************************************************************
+//
+//	Function:	setNonBlocking
+//	Purpose:	Puts socket in non-blocking mode
+//	Return:		True if error occurs
+//
+//***************************************************************************************
+bool cReactor::setNonBlocking(SOCKET socket)
+{
+#ifdef _WIN32
+	u_long mode(1);
+	return ioctlsocket(socket, FIONBIO, &mode) != 0;
+#else
+	int flags = fcntl(socket, F_GETFL, 0);
+	return flags < 0 || fcntl(socket, F_SETFL, flags | O_NONBLOCK) < 0;
+#endif
+}
+
+//***************************************************************************************
+//
+//	Function:	wouldBlock
+//	Purpose:	Checks whether the last failed socket call only lacked data or space
+//	Return:		True if call would have blocked
+//
+//***************************************************************************************
+bool cReactor::wouldBlock()
+{
+#ifdef _WIN32
+	return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+	return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#endif
+}
@@ -0,0 +1,1284 @@
+//***************************************************************************************
+//
+//	Date Created:	October 17, 2026
+//	File:			BTRoom.h
+//	Project:		Blue Tetris
+//
+//	Purpose:		Game rooms for the Blue Tetris server. A room holds up to four
+//					players and runs their games; each room is owned by one worker
+//					thread, which executes every message sent to that room.
+//
+//***************************************************************************************
+
+#pragma once
+
+#define ROOM_MAXCLIENTS		4			// Players per room (client ID is 3 bits)
+
+#define ROOM_EVENT_JOIN		0			// Room event types: new connection seated
+#define ROOM_EVENT_MOVE		1			// Client seated from another room
+#define ROOM_EVENT_LEAVE	2			// Client left room or disconnected
+#define ROOM_EVENT_MESSAGE	3			// Client message
+#define ROOM_EVENT_STOP		4			// Ends worker thread
+#define ROOM_EVENTSIZE		1024		// Capacity of a worker's event ring
+#define ROOM_BOTFILL		4			// Seats filled with bots when a game starts
+#define ROOM_BOTLEVEL		BOT_NORMAL	// Difficulty of those bots
+#define ROOM_TICK			20			// Milliseconds between bot updates
+
+#include <queue>
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <time.h>
+#include "resource.h"
+#include "BTReactor.h"
+#include "ringbuffer.h"
+#include "BTScores.h"
+#include "trisengine.h"
+#include "boardsync.h"
+#include "bot.h"
+
+#ifdef __linux__
+#include <pthread.h>
+#endif
+
+using std::queue;
+using std::vector;
+using std::string;
+using std::thread;
+using std::mutex;
+using std::lock_guard;
+using std::atomic;
+
+//***************************************************************************************
+//
+//	Class:		cRoom
+//	Purpose:	State and game logic of one multiplayer room. Only the room's worker
+//				thread calls its functions, except accepting(), which is read by the
+//				lobby on the socket thread.
+//
+//***************************************************************************************
+class cRoom
+{
+public:
+	cRoom(int number, cReactor* reactor);		// Constructor
+
+	void join(int id, int conn, bool announce);	// Seats client in room
+	void leave(int id);							// Frees client's seat
+	void receive(string message);				// Executes client message
+	void flush();								// Hands queued messages to the reactor
+	void tick(long long now);					// Applies bots' input due at given time
+
+	int number() { return mNumber; }
+	bool accepting() { return mOpen; }			// True if not in game
+	bool ticking();								// True if bots are playing
+
+private:
+
+	void reset();								// Returns room to waiting state
+	void seatBots();							// Fills empty seats with bots
+	void dismissBots();							// Frees seats held by bots
+
+	bool checkValidity(string message);		// Checks if recieved message is valid
+	void execute(string message);			// Executes command
+	void handleGlobal(string message);		// Handles global messages
+	void handleRoom(string message);		// Handles room messages
+	void handleGame(string message);		// Handles game messages
+
+	void send(int state, int message, int id, int target);
+	void send(string message);
+	void sendAll(const string message);
+	void sendAll(int state, int message, int id);
+	void sendAll(int state, string message, int id);
+	void sendOthers(const string message);
+
+	bool lock(string message);				// Locks down specified tetris units
+	void replay(string message);			// Replays client's input events
+	int input(int id, int command);			// Applies one input event to a board
+	void reportTetrad(int id);				// Reports location of a bot's tetrad
+	void lockdown(int id, int units[]);		// Reports tetrad locked by replay
+	void drawCheck(int id);					// Reports new tetrad list when due
+	void fixBoard(int id, int target, int acked);	// Dictates what the client's board looks like
+	void reportNextList(int id);			// Dictates client's list of upcoming tetrads
+	void reportClientStates(int id);		// Reports client states to given client
+
+	void overflowCheck(int id);				// Performs game over check
+	void endGame();							// Handles end of multiplayer game
+
+	void sendScoreList(string message);		// Score communication functions
+	void sendRankList(string message);
+	void checkScore(string message);
+
+	bool checkID(int id);					// Checks whether ID is in valid range
+
+	int mNumber;							// Room number
+	cReactor* mReactor;						// Delivers messages to clients
+	atomic<bool> mOpen;						// Flags room in waiting state
+	int mInvalidMessages;					// Tracks number of ignored messages
+
+	cTrisEngine mBoard[ROOM_MAXCLIENTS];	// Players' boards
+	cRandom mSeeds;							// Draws a seed for each board per game
+	int mClientCount;						// Number of clients in room, bots excluded
+	cScorePartition* mLeaderboard;			// High scores of the room's board settings
+	queue<string> mMessages[ROOM_MAXCLIENTS]; // Message queue for all players
+	bool mPresent[ROOM_MAXCLIENTS];			// Flags for occupied client IDs
+	int mClientMap[ROOM_MAXCLIENTS];		// Maps occupied client IDs to connection id
+	bool mBot[ROOM_MAXCLIENTS];				// Flags IDs played by the server
+	cBot mBots[ROOM_MAXCLIENTS];			// Players of those IDs
+	bool mReady[ROOM_MAXCLIENTS];			// Flags for players in ready state
+	bool mPlaying[ROOM_MAXCLIENTS];			// Flags for players who are currently in game
+	int mState;								// Room's game state
+	int mLocalState;						// Substate local to server
+	int mDrawIndex[ROOM_MAXCLIENTS];		// Tetrad drawing index for each player
+	int mFrame[ROOM_MAXCLIENTS];			// Frame number of last replayed input
+	int mRevision[ROOM_MAXCLIENTS];			// Board revision; advances with each lock
+	cBoardImage mSynced[ROOM_MAXCLIENTS][ROOM_MAXCLIENTS];	// Boards as last sent, by target
+};
+
+//***************************************************************************************
+//
+//	Class:		cRoomEvent
+//	Purpose:	Unit of work passed from the socket thread to a room's worker
+//
+//***************************************************************************************
+class cRoomEvent
+{
+public:
+	cRoomEvent(): mType(ROOM_EVENT_MESSAGE), mRoom(NULL), mClient(0), mConn(-1) {}
+	cRoomEvent(int type, cRoom* room, int client, int conn, string message = string()):
+		mType(type), mRoom(room), mClient(client), mConn(conn), mMessage(message) {}
+
+	int mType;								// Event type (ROOM_EVENT_*)
+	cRoom* mRoom;							// Target room
+	int mClient;							// Client ID within room
+	int mConn;								// Reactor connection of client
+	string mMessage;						// Message, client ID already encoded
+};
+
+//***************************************************************************************
+//
+//	Class:		cRoomWorker
+//	Purpose:	Thread that owns a fixed set of rooms and executes their events in
+//				order. Events arrive from the socket thread through a lock-free
+//				ring; the worker sleeps while the ring is empty, waking every
+//				ROOM_TICK while any of its rooms has bots playing.
+//
+//***************************************************************************************
+class cRoomWorker
+{
+public:
+	cRoomWorker(cReactor* reactor): mReactor(reactor), mEvents(ROOM_EVENTSIZE) {}
+
+	void start(int core);					// Launches thread, pinned to core if possible
+	void stop();							// Finishes queued events and joins thread
+	void post(const cRoomEvent &event);		// Queues event; socket thread only
+
+private:
+
+	void run();								// Thread body
+	static long long now();					// Milliseconds on a steady clock
+
+	cReactor* mReactor;						// Socket thread delivering the output
+	thread mThread;							// Worker thread
+	cSPSCRing<cRoomEvent> mEvents;			// Pending events
+};
+
+//***************************************************************************************
+//
+//	Function:	constructor
+//	Purpose:	Initializes room in waiting state
+//
+//***************************************************************************************
+cRoom::cRoom(int number, cReactor* reactor): mNumber(number), mReactor(reactor),
+mOpen(true), mInvalidMessages(0),
+mSeeds((unsigned long long)time(NULL) ^ (unsigned long long)number << 32), mClientCount(0),
+mLeaderboard(BTSPartition(BOARDWIDTH, BOARDDEPTH, 0))
+{
+	for(int i(0); i < ROOM_MAXCLIENTS; i++)
+	{
+		mPresent[i] = false;
+		mClientMap[i] = -1;
+		mBot[i] = false;
+	}
+
+	reset();
+}
+
+//***************************************************************************************
+//
+//	Function:	reset
+//	Purpose:	Returns room to waiting state, clearing game data
+//
+//***************************************************************************************
+void cRoom::reset()
+{
+	dismissBots();
+
+	mLocalState = 0;
+	mState = S_ROOM;
+
+	for(int i(0); i < ROOM_MAXCLIENTS; i++)
+	{
+		mReady[i] = false;
+		mPlaying[i] = false;
+		mDrawIndex[i] = 0;
+		mFrame[i] = 0;
+		mRevision[i] = 0;
+		mBoard[i] = cTrisEngine();
+
+		for(int j(0); j < ROOM_MAXCLIENTS; j++)
+			mSynced[i][j].clear();
+	}
+
+	mOpen = true;
+}
+
+//***************************************************************************************
+//
+//	Function:	seatBots
+//	Purpose:	Seats bots in empty IDs once every player is ready, up to
+//				ROOM_BOTFILL players in all, and announces them. The room stops
+//				accepting newcomers so the lobby leaves their seats alone.
+//
+//***************************************************************************************
+void cRoom::seatBots()
+{
+	int seated(mClientCount);
+
+	for(int id(0); id < ROOM_MAXCLIENTS && seated < ROOM_BOTFILL; id++)
+	{
+		if(mPresent[id])
+			continue;
+
+		mBot[id] = true;
+		mBots[id].reset();
+		mBots[id].setDifficulty(ROOM_BOTLEVEL);
+		mPresent[id] = true;
+		mClientMap[id] = -1;
+		mReady[id] = false;
+		mPlaying[id] = true;				// Bots enter the game without being asked
+		seated++;
+
+		while(!mMessages[id].empty())
+			mMessages[id].pop();
+
+		sendOthers(string(1, char(id + S_GLOBAL * 8 + BT_CODE * 32)) + char(M_CONNECT));
+		sendAll(S_GLOBAL, M_PLAYING, id);
+	}
+
+	if(seated > mClientCount)
+		mOpen = false;
+}
+
+//***************************************************************************************
+//
+//	Function:	dismissBots
+//	Purpose:	Frees every seat held by a bot and broadcasts its disconnection
+//
+//***************************************************************************************
+void cRoom::dismissBots()
+{
+	for(int id(0); id < ROOM_MAXCLIENTS; id++)
+	{
+		if(!mBot[id])
+			continue;
+
+		mBot[id] = false;
+		mPresent[id] = false;
+		mPlaying[id] = false;
+
+		while(!mMessages[id].empty())
+			mMessages[id].pop();
+
+		sendAll(S_GLOBAL, M_DISCONNECT, id);
+	}
+}
+
+//***************************************************************************************
+//
+//	Function:	join
+//	Purpose:	Seats client in given ID and reports client states to it. If
+//				announce is set the client is moving from another room and is sent
+//				its new ID; new connections already received it from the lobby.
+//
+//***************************************************************************************
+void cRoom::join(int id, int conn, bool announce)
+{
+	if(!checkID(id))
+		return;
+
+	if(mBot[id])								// Seated before the lobby saw game start
+	{
+		mBot[id] = false;
+		mPresent[id] = false;
+		sendAll(S_GLOBAL, M_DISCONNECT, id);
+	}
+
+	mPresent[id] = true;						// Flag ID as taken
+	mClientMap[id] = conn;						// Map client ID to connection
+	mReady[id] = false;
+	mPlaying[id] = false;
+	mClientCount++;
+
+	while(!mMessages[id].empty())				// Discard previous occupant's messages
+		mMessages[id].pop();
+
+	if(announce)
+	{
+		string message;
+		message += C_GLOBAL + S_GLOBAL * 8 + BT_CODE * 32;
+		message += M_ASSIGN_ID;
+		message += id + NUMERAL_OFFSET;
+		mMessages[id].push(message);
+	}
+
+	reportClientStates(id);						// Report client states to newcomer
+	sendOthers(string(1, char(id + S_GLOBAL * 8 + BT_CODE * 32)) + char(M_CONNECT));
+}
+
+//***************************************************************************************
+//
+//	Function:	leave
+//	Purpose:	Frees client's seat and broadcasts disconnection. An emptied room,
+//				or a game whose remaining players have all topped out, ends. Bots
+//				do not keep a game going.
+//
+//***************************************************************************************
+void cRoom::leave(int id)
+{
+	if(!checkID(id) || mClientMap[id] == -1)
+		return;
+
+	mPresent[id] = false;
+	mReady[id] = false;
+	mPlaying[id] = false;
+	mClientMap[id] = -1;
+	mClientCount--;
+
+	while(!mMessages[id].empty())
+		mMessages[id].pop();
+
+	sendAll(S_GLOBAL, M_DISCONNECT, id);		// Broadcast disconnection
+
+	if(mClientCount == 0)
+		reset();
+	else if(mState == S_GAME)
+	{
+		bool gameEnd(true);
+		for(int i(0); i < ROOM_MAXCLIENTS; i++)
+			if(mPresent[i] && !mBot[i] && !mBoard[i].gameOver())
+				gameEnd = false;
+
+		if(gameEnd)
+			endGame();
+	}
+}
+
+//***************************************************************************************
+//
+//	Function:	receive
+//	Purpose:	Executes valid client message
+//
+//***************************************************************************************
+void cRoom::receive(string message)
+{
+	if(checkValidity(message))
+		mInvalidMessages++;
+	else
+		execute(message);
+}
+
+//***************************************************************************************
+//
+//	Function:	flush
+//	Purpose:	Hands each client's queued messages to the reactor in one piece,
+//				each message encoded as a frame
+//
+//***************************************************************************************
+void cRoom::flush()
+{
+	string buff;
+
+	for(int id(0); id < ROOM_MAXCLIENTS; id++)
+	{
+		buff.clear();
+
+		while(!mMessages[id].empty())
+		{
+			cFrame::encode(buff, mMessages[id].front());
+			mMessages[id].pop();
+		}
+
+		if(!buff.empty() && mPresent[id] && mClientMap[id] != -1)
+			mReactor->post(mClientMap[id], buff);
+	}
+}
+
+//***************************************************************************************
+//
+//	Function:	ticking
+//	Purpose:	Checks whether the room needs tick() calls
+//	Return:		True if a game is running with bots seated
+//
+//***************************************************************************************
+bool cRoom::ticking()
+{
+	bool bots(false);
+
+	for(int id(0); id < ROOM_MAXCLIENTS; id++)
+		bots = bots || mBot[id];
+
+	return bots && mState == S_GAME;
+}
+
+//***************************************************************************************
+//
+//	Function:	tick
+//	Purpose:	Applies each bot's input events due at the given time (ms) to its
+//				board, as replay() applies a client's, and reports where its
+//				falling tetrad has moved
+//
+//***************************************************************************************
+void cRoom::tick(long long now)
+{
+	int event;
+	bool moved;
+
+	for(int id(0); id < ROOM_MAXCLIENTS && mState == S_GAME; id++)
+	{
+		moved = false;
+
+		while(mBot[id] && mState == S_GAME && (event = mBots[id].next(mBoard[id], now)))
+		{
+			moved = true;
+
+			if(input(id, event) > 0 && mBot[id])	// Lock may have ended the game
+				mBots[id].locked(mBoard[id], now);
+		}
+
+		if(moved && mBot[id] && mState == S_GAME)
+			reportTetrad(id);
+	}
+}
+
+//***************************************************************************************
+//
+//	Function:	checkValidity
+//	Purpose:	Checks if recieved message is a valid Blue Tetris instruction
+//	Return:		True if message is invalid
+//
+//***************************************************************************************
+bool cRoom::checkValidity(string message)
+{
+	bool invalid(false);
+	int state = (message[0]>>3 & 0x3);
+
+	invalid = !((message[0]>>5 & 0x7) == BT_CODE);	// Check for signature BT bits
+
+	if(!invalid)
+		invalid = !(state == mState || state == 0);	// Check for valid gamestate
+
+	return invalid;
+}
+
+//***************************************************************************************
+//
+//	Function:	execute
+//	Purpose:	Interprets and executes message
+//
+//***************************************************************************************
+void cRoom::execute(string message)
+{
+	int state = (message[0]>>3 & 0x3);
+
+	switch(state)
+	{
+	case S_GLOBAL:
+		handleGlobal(message);
+		break;
+
+	case S_ROOM:
+		handleRoom(message);
+		break;
+
+	case S_GAME:
+		handleGame(message);
+		break;
+	};
+}
+
+//***************************************************************************************
+//
+//	Function:	handleGlobal
+//	Purpose:	Handles messages with global state code
+//
+//***************************************************************************************
+void cRoom::handleGlobal(string message)
+{
+	int id = (message[0] & 0x7);					// Mask off client ID
+	int code = message[1];
+
+	switch(code)
+	{
+	case M_DISCONNECT:
+		mPresent[id] = false;		// Note: disconnect message broadcast by leave()
+		mReady[id] = false;
+		mPlaying[id] = false;
+		break;
+
+	case M_REQUEST_SCORE:				// Answer score list requests
+		sendScoreList(message);
+		break;
+
+	case M_HIGH_SCORE_SUBMIT:			// Submit high score to database
+		BTSSubmitScore(BTSMessagePartition(mLeaderboard, message,
+			2 + NAME_LENGTH + SCORE_LENGTH), message);
+		break;
+
+	case M_REQUEST_RANK:				// Answer rank requests
+		sendRankList(message);
+		break;
+
+	case M_APPEARANCE:					// Setting reports: Echo to other clients
+	case M_FRAME:
+	case M_GRID:
+		sendOthers(message);
+		break;
+	};
+}
+
+//***************************************************************************************
+//
+//	Function:	handleRoom
+//	Purpose:	Handles messages with room state code
+//
+//***************************************************************************************
+void cRoom::handleRoom(string message)
+{
+	int id = (message[0] & 0x7);					// Mask off client ID
+	int code = message[1];
+
+	if(mLocalState == 0)					// Room Messages: Waiting ------------------
+	{
+		if(code == M_READY)					// Client enters ready state
+		{
+			mReady[id] = true;
+			sendAll(message);
+
+			bool allReady(true);
+			for(int i(0); i < 4 && allReady; i++)
+				if(mPresent[i])
+					allReady = mReady[i];
+
+			if(allReady)					// Broadcast Enter Game State message
+			{
+				seatBots();
+
+				string enterMsg;
+				enterMsg += M_ENTER_GAME_STATE;
+				enterMsg += (mPresent[0] + mPresent[1] * 2 + mPresent[2] * 4 + mPresent[3] * 8);
+				sendAll(S_ROOM, enterMsg, C_GLOBAL);
+				mLocalState++;
+			}
+		}
+		if(code == M_NOT_READY)				// Client leaves ready state
+		{
+			mReady[id] = false;
+			sendAll(message);
+		}
+	}
+
+	else if(mLocalState == 1) // Room Messages: Starting Game -------
+	{
+		if(code == M_ENTER_GAME_STATE)		// Client enters game state
+		{
+			mReady[id] = false;				// Update states
+			mPlaying[id] = true;
+		}
+
+		bool allReady(true);				// Check if all are ready
+		for(int i(0); i < 4 && allReady; i++)
+			if(mPresent[i])
+				allReady = !mReady[i];
+
+		if(allReady)					// If all are ready
+		{
+			for(int i(0); i < 4; i++)	// Send out initial tetrad lists
+			{
+				if(mPresent[i])
+				{
+					unsigned long long seed = mSeeds.next();	// Fresh sequence per board
+					seed = seed << 32 | mSeeds.next();
+
+					mBoard[i].setSeed(seed);
+					mBoard[i].start();
+					mDrawIndex[i] = 2;
+					reportNextList(i);
+				}
+			}
+
+			sendAll(S_ROOM, M_START_GAME, C_GLOBAL);
+			mLocalState++;
+			mState = S_GAME;
+			mOpen = false;					// Lobby stops seating newcomers
+		}
+	}
+}
+
+//***************************************************************************************
+//
+//	Function:	handleGame
+//	Purpose:	Handles messages with game state code
+//
+//***************************************************************************************
+void cRoom::handleGame(string message)
+{
+	int id = (message[0] & 0x7);					// Mask off client ID
+	int code = message[1];
+
+	if(code == M_INPUT)					// Lockstep input: server's board decides
+	{
+		replay(message);
+		return;
+	}
+
+	switch(code)
+	{
+	case M_LOCKDOWN:					// Locks come from replay alone; a client's
+		mInvalidMessages++;				// account of its board is never trusted
+		break;
+
+	case M_REQUEST_FIX:					// Respond to board fix requests
+		if(message.length() >= 5)		// Board ID, acknowledged revision
+			fixBoard(message[2] - NUMERAL_OFFSET, id,
+				(unsigned char)message[3] << 8 | (unsigned char)message[4]);
+		else if(message.length() >= 3)
+			fixBoard(message[2] - NUMERAL_OFFSET, id, SYNC_NO_BASE);
+		break;
+
+	case M_TETRAD:
+		sendOthers(message);
+		break;
+	};
+}
+
+void cRoom::send(int state, int message, int id, int target)
+{
+	char code = id + state * 8 + BT_CODE * 32;
+	string newMsg;
+	newMsg = code;
+	newMsg += message;
+
+	mMessages[target].push(newMsg);
+}
+
+void cRoom::send(string message)
+{
+	int client = message[0] & 7;
+
+	if(client >= 0 && client <= 4)
+		mMessages[client].push(message);
+}
+
+//***************************************************************************************
+//
+//	Function:	sendAll
+//	Purpose:	Places message in all present clients' send queues
+//
+//***************************************************************************************
+void cRoom::sendAll(int state, int message, int id)
+{
+	char code = id + state * 8 + BT_CODE * 32;
+	string newMsg;
+	newMsg = code;
+	newMsg += message;
+
+	sendAll(newMsg);
+}
+
+void cRoom::sendAll(int state, string message, int id)
+{
+	char code = id + state * 8 + BT_CODE * 32;
+	string newMsg;
+	newMsg = code;
+	newMsg += message;
+
+	sendAll(newMsg);
+}
+
+void cRoom::sendAll(const string message)
+{
+	for(int i(0); i < 4; i++)
+		if(mPresent[i])
+			mMessages[i].push(message);
+}
+
+//***************************************************************************************
+//
+//	Function:	sendOthers
+//	Purpose:	Sends message to all but the client identified in the message
+//
+//***************************************************************************************
+void cRoom::sendOthers(const string message)
+{
+	int id = message[0] & 7;
+	for(int i(0); i < 4; i++)
+		if(mPresent[i] && i != id)
+			mMessages[i].push(message);
+}
+
+//***************************************************************************************
+//
+//	Function:	fixBoard
+//	Purpose:	Sends target the rows of a board that differ from the image it
+//				acknowledged. If the acknowledged revision is not the last one
+//				sent to target, the whole board is sent against an empty image.
+//
+//***************************************************************************************
+void cRoom::fixBoard(int id, int target, int acked)
+{
+	if(!checkID(id))
+		return;
+
+	if(target == C_GLOBAL)
+	{
+		for(int i(0); i < ROOM_MAXCLIENTS; i++)
+			if(mPresent[i])
+				fixBoard(id, i, mSynced[i][id].revision());
+	}
+	else if(checkID(target))
+	{
+		cBoardImage &image = mSynced[target][id];
+		string message;
+		message += id + mState * 8 + BT_CODE * 32;
+		message += M_BOARD;
+
+		if(acked != image.revision())
+			image.clear();
+
+		image.sync(message, mBoard[id], mRevision[id]);
+		mMessages[target].push(message);
+	}
+}
+
+//***************************************************************************************
+//
+//	Function:	reportNextList
+//	Purpose:	Reports list of upcoming tetrad types to client
+//
+//***************************************************************************************
+void cRoom::reportNextList(int id)
+{
+	if(checkID(id))
+	{
+		string message;
+
+		message += id + S_GLOBAL * 8 + BT_CODE * 32;
+		message += M_NEXT;
+
+		for(int i(0); i < 7; i++)
+		{
+			message += mBoard[id].getNext(i) + NUMERAL_OFFSET;
+		}
+
+		send(message);
+	}
+}
+
+//***************************************************************************************
+//
+//	Function:	reportClientStates
+//	Purpose:	Reports state of all clients to given client (connected, ready)
+//
+//***************************************************************************************
+void cRoom::reportClientStates(int id)
+{
+	if(checkID(id))
+	{
+		for(int i(0); i < 4; i++)
+		{
+			if(mPresent[i])
+				send(S_GLOBAL, M_CONNECT, i, id);
+			else
+				send(S_GLOBAL, M_DISCONNECT, i, id);
+
+			if(mReady[i])
+				send(S_GLOBAL, M_READY, i, id);
+			else
+				send(S_GLOBAL, M_NOT_READY, i, id);
+
+			if(mPlaying[i])
+				send(S_GLOBAL, M_PLAYING, i, id);
+			else
+				send(S_GLOBAL, M_IDLE, i, id);
+		}
+	}
+}
+
+//***************************************************************************************
+//
+//	Function:	checkID
+//	Purpose:	Checks if ID is in valid bounds
+//	Returns:	True if valid ID
+//
+//***************************************************************************************
+bool cRoom::checkID(int id)
+{
+	if(id >= 0 && id < 4)
+		return true;
+	else
+		return false;
+}
+
+//***************************************************************************************
+//
+//	Function:	lock
+//	Purpose:	Locks down specified tetris units
+//	Return:		True if any specified locations are occupied (data inconsistancy)
+//				or the message is too short to hold four units
+//
+//***************************************************************************************
+bool cRoom::lock(string message)
+{
+	bool occupied(false);
+	int id = message[0] & 7;
+	int type[4];
+	int x[4];
+	int y[4];
+	int n(2);
+	int i;
+
+	if(message.length() < 14)					// Units missing: nothing to lock
+		return true;
+
+	for(i = 0; i < 4 && !occupied; i++)			// Read data from string
+	{
+		type[i] = message[n++] - NUMERAL_OFFSET;
+		x[i] = message[n++] - NUMERAL_OFFSET;
+		y[i] = message[n++] - NUMERAL_OFFSET;
+
+		occupied = mBoard[id].check(x[i], y[i]); // Check for data inconsistancie
+	}
+
+	if(!occupied)								// Add units if no problem
+	{
+		for(i = 0; i < 4; i++)
+		{
+			mBoard[id].add(x[i], y[i], type[i]);
+		}
+		mBoard[id].clearLines();
+		mRevision[id] = cBoardImage::nextRevision(mRevision[id]);
+	}
+
+	drawCheck(id);
+
+	return occupied;
+}
+
+//***************************************************************************************
+//
+//	Function:	replay
+//	Purpose:	Executes client's input events on the server's copy of its board.
+//				Events only count while a tetrad is falling, as on the client, so
+//				both boards pass through the same states. Tetrads locked here are
+//				reported to the other players; the client's own account of its
+//				board is never trusted. Events whose frame numbers run backwards
+//				end the message.
+//
+//***************************************************************************************
+void cRoom::replay(string message)
+{
+	int id = message[0] & 7;
+	int command;
+	int frame;
+
+	for(unsigned int n(2); n + INPUT_EVENTSIZE <= message.length() && mState == S_GAME;
+		n += INPUT_EVENTSIZE)
+	{
+		command = (unsigned char)message[n];
+		frame = (unsigned char)message[n + 1] << 8 | (unsigned char)message[n + 2];
+
+		if(((frame - mFrame[id]) & 0xFFFF) >= 0x8000 || !mBoard[id].getTetradPtr())
+		{
+			mInvalidMessages++;
+			return;
+		}
+
+		if(command < I_LEFT || command > I_GRAVITY)
+		{
+			mInvalidMessages++;
+			return;
+		}
+
+		mFrame[id] = frame;
+		input(id, command);
+	}
+}
+
+//***************************************************************************************
+//
+//	Function:	input
+//	Purpose:	Applies one input event to a board, reporting any tetrad it locks
+//	Return:		Result of the engine call; positive if a tetrad locked
+//
+//***************************************************************************************
+int cRoom::input(int id, int command)
+{
+	int units[12];
+	int cleared;
+	int result(0);
+
+	switch(command)
+	{
+	case I_LEFT:
+		mBoard[id].moveLeft();
+		break;
+
+	case I_RIGHT:
+		mBoard[id].moveRight();
+		break;
+
+	case I_DOWN:
+		result = mBoard[id].moveDown(cleared, units);
+		break;
+
+	case I_SONIC_LOCK:
+		result = mBoard[id].sonicLock(cleared, units);
+		break;
+
+	case I_ROTATE_LEFT:
+		mBoard[id].rotateLeft();
+		break;
+
+	case I_ROTATE_RIGHT:
+		mBoard[id].rotateRight();
+		break;
+
+	case I_GRAVITY:
+		result = mBoard[id].forceDown(cleared, units);
+		break;
+	};
+
+	if(result > 0)
+		lockdown(id, units);
+
+	return result;
+}
+
+//***************************************************************************************
+//
+//	Function:	lockdown
+//	Purpose:	Reports a tetrad locked by replay to the other players
+//
+//***************************************************************************************
+void cRoom::lockdown(int id, int units[])
+{
+	string message;
+	message += id + S_GAME * 8 + BT_CODE * 32;
+	message += M_LOCKDOWN;
+
+	for(int i(0); i < 12; i++)
+		message += units[i] + NUMERAL_OFFSET;
+
+	sendOthers(message);
+	mRevision[id] = cBoardImage::nextRevision(mRevision[id]);
+	drawCheck(id);
+	overflowCheck(id);						// May end the game
+}
+
+//***************************************************************************************
+//
+//	Function:	reportTetrad
+//	Purpose:	Reports location of the falling tetrad on a bot's board to the
+//				players, as clients report their own
+//
+//***************************************************************************************
+void cRoom::reportTetrad(int id)
+{
+	cTetrad* tetrad = mBoard[id].getTetradPtr();
+	string message;
+
+	if(tetrad)
+	{
+		message += id + S_GAME * 8 + BT_CODE * 32;
+		message += M_TETRAD;
+		message += tetrad->type();
+
+		for(int i(0); i < 4; i++)
+		{
+			message += tetrad->x(i) + NUMERAL_OFFSET;
+			message += tetrad->y(i) + NUMERAL_OFFSET;
+		}
+
+		sendOthers(message);
+	}
+}
+
+//***************************************************************************************
+//
+//	Function:	drawCheck
+//	Purpose:	Counts a locked tetrad; once the client has drawn its whole list,
+//				draws and reports the next one
+//
+//***************************************************************************************
+void cRoom::drawCheck(int id)
+{
+	mDrawIndex[id]++;
+	if(mDrawIndex[id] == 7)
+	{
+		mBoard[id].redraw();
+		reportNextList(id);
+		mDrawIndex[id] = 0;
+	}
+}
+
+//***************************************************************************************
+//
+//	Function:	overflowCheck
+//	Purpose:	Checks given board for gameover state
+//				If all clients are at game over state, calls function to end game;
+//				bots still playing do not hold it open
+//
+//***************************************************************************************
+void cRoom::overflowCheck(int id)
+{
+	bool gameEnd(false);
+
+	if(mBoard[id].gameOver())			// Check if this player has topped out
+	{
+		gameEnd = true;
+		for(int i(0); i < 4; i++)		// For each player
+		{
+			if(mPresent[i] && !mBot[i] && !mBoard[i].gameOver())	// If this player is present and still playing
+				gameEnd = false;				// Game has not ended
+		}
+	}
+
+	if(gameEnd)							// If game has ended
+		endGame();					// Call end game function
+}
+
+//***************************************************************************************
+//
+//	Function:	endGame
+//	Purpose:	Handles end of multiplayer game
+//
+//***************************************************************************************
+void cRoom::endGame()
+{
+	sendAll(S_GAME, M_GAME_END, C_GLOBAL);	// Send game end message to all clients
+	reset();							// Room returns to waiting state
+}
+
+//***************************************************************************************
+//
+//	Function:	sendScoreList
+//	Purpose:	Sends client the high score list of the board settings it names,
+//				or of the room's board
+//
+//***************************************************************************************
+void cRoom::sendScoreList(string message)
+{
+	int id = message[0] & 7;
+
+	if(checkID(id))
+		mMessages[id].push(BTSScoreList(BTSMessagePartition(mLeaderboard, message, 2)));
+}
+
+//***************************************************************************************
+//
+//	Function:	sendRankList
+//	Purpose:	Sends client the rank of a player's high score and the scores
+//				around it, on the board settings it names or the room's board
+//
+//***************************************************************************************
+void cRoom::sendRankList(string message)
+{
+	int id = message[0] & 7;
+
+	if(checkID(id))
+		mMessages[id].push(BTSRankList(
+			BTSMessagePartition(mLeaderboard, message, 2 + NAME_LENGTH), message));
+}
+
+//***************************************************************************************
+//
+//	Function:	checkScore
+//	Purpose:	Checks a client score against server high scores.
+//				Returns a message to the client stating the next action.
+//
+//***************************************************************************************
+void cRoom::checkScore(string message)
+{
+	int id = message[0] & 7;
+
+	int n(2);
+	long double score = BTSParseScore(message, n);
+	cScorePartition* partition = BTSMessagePartition(mLeaderboard, message, n);
+
+	if(BTSHighScore(partition, score))	// If it makes the score list
+		send(S_GLOBAL, M_HIGH_SCORE_ACHIEVED, id, id);
+	else
+		send(S_GLOBAL, M_NO_HIGH_SCORE, id, id);
+}
+
+//***************************************************************************************
+//
+//	Function:	start
+//	Purpose:	Launches worker thread. On Linux the thread is pinned to the given
+//				core so its rooms stay in that core's caches.
+//
+//***************************************************************************************
+void cRoomWorker::start(int core)
+{
+	mThread = thread(&cRoomWorker::run, this);
+
+#ifdef __linux__
+	cpu_set_t cpus;
+	CPU_ZERO(&cpus);
+	CPU_SET(core, &cpus);
+	pthread_setaffinity_np(mThread.native_handle(), sizeof(cpus), &cpus);
+#endif
+}
+
+//***************************************************************************************
+//
+//	Function:	stop
+//	Purpose:	Asks worker to finish queued events and waits for it to exit.
+//				Socket thread only.
+//
+//***************************************************************************************
+void cRoomWorker::stop()
+{
+	post(cRoomEvent(ROOM_EVENT_STOP, NULL, 0, -1));
+
+	if(mThread.joinable())
+		mThread.join();
+}
+
+//***************************************************************************************
+//
+//	Function:	post
+//	Purpose:	Queues event for worker and wakes it if it was idle. While the ring
+//				is full the socket thread keeps delivering posted output, since the
+//				worker may itself be waiting for room in the reactor's ring.
+//
+//***************************************************************************************
+void cRoomWorker::post(const cRoomEvent &event)
+{
+	while(mEvents.tryPush(event))
+	{
+		mReactor->drainPosted();
+		std::this_thread::yield();
+	}
+}
+
+//***************************************************************************************
+//
+//	Function:	run
+//	Purpose:	Executes queued events in arrival order and runs the bots of rooms
+//				in game, then flushes the output of every room touched
+//
+//***************************************************************************************
+void cRoomWorker::run()
+{
+	cRoomEvent event;
+	vector<cRoom*> touched;
+	vector<cRoom*> ticking;					// Rooms with bots playing
+	long long nextTick(now());
+	long long time;
+	unsigned int i;
+	bool stopping(false);
+	bool idle;
+
+	while(!stopping)
+	{
+		if(ticking.empty())
+		{
+			mEvents.waitPop(event);				// Sleep until work arrives
+			idle = false;
+		}
+		else
+		{
+			time = now();
+			idle = mEvents.waitPop(event, nextTick > time ? (int)(nextTick - time) : 0);
+		}
+
+		while(!idle)							// Execute everything already queued
+		{
+			switch(event.mType)
+			{
+			case ROOM_EVENT_JOIN:
+			case ROOM_EVENT_MOVE:
+				event.mRoom->join(event.mClient, event.mConn, event.mType == ROOM_EVENT_MOVE);
+				break;
+
+			case ROOM_EVENT_LEAVE:
+				event.mRoom->leave(event.mClient);
+				break;
+
+			case ROOM_EVENT_MESSAGE:
+				event.mRoom->receive(event.mMessage);
+				break;
+
+			case ROOM_EVENT_STOP:
+				stopping = true;
+				break;
+			};
+
+			if(event.mRoom && (touched.empty() || touched.back() != event.mRoom))
+				touched.push_back(event.mRoom);
+
+			idle = stopping || mEvents.tryPop(event);
+		}
+
+		for(i = 0; i < touched.size(); i++)		// Rooms whose games just started
+			if(touched[i]->ticking() &&
+				std::find(ticking.begin(), ticking.end(), touched[i]) == ticking.end())
+				ticking.push_back(touched[i]);
+
+		time = now();
+		if(!ticking.empty() && time >= nextTick)
+		{
+			for(i = 0; i < ticking.size(); i++)
+			{
+				ticking[i]->tick(time);
+				touched.push_back(ticking[i]);
+			}
+
+			for(i = 0; i < ticking.size(); )		// Drop rooms whose games ended
+			{
+				if(ticking[i]->ticking())
+					i++;
+				else
+				{
+					ticking[i] = ticking.back();
+					ticking.pop_back();
+				}
+			}
+
+			nextTick = time + ROOM_TICK;
+		}
+
+		for(i = 0; i < touched.size(); i++)		// Rooms repeat only if interleaved
+			touched[i]->flush();
+
+		touched.clear();
+	}
+}
+
+//***************************************************************************************
+//
+//	Function:	now
+//	Purpose:	Reads a steady clock for bot timing
+//	Return:		Milliseconds since an arbitrary start
+//
+//***************************************************************************************
+long long cRoomWorker::now()
+{
+	return std::chrono::duration_cast<std::chrono::milliseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
@@ -0,0 +1,696 @@
+//***************************************************************************************
+//
+//	Date Created:	October 17, 2026
+//	File:			BTScores.h
+//	Project:		Blue Tetris
+//
+//	Purpose:		High score functions for the Blue Tetris server. Every board size
+//					and starting level has its own unbounded leaderboard, shared by
+//					the rooms playing it, so all access is serialized by mScoreLock.
+//					Leaderboards live in memory; rooms read a prepared message and a
+//					writer thread stores submissions, so no room waits on storage.
+//
+//***************************************************************************************
+
+#pragma once
+
+#define BT_SERVER_SCOREFILE		"Data/serverscores.dat"	// Text list, imported once
+#define BTS_WRITEBATCH			100		// Milliseconds submissions gather before a write
+#define BTS_RETRYDELAY			1000	// Milliseconds before a failed write is retried
+#define BTS_RETRYLIMIT			30000	// Longest wait between retries
+#define BTS_LISTLENGTH			10		// Entries in score and rank list messages
+#define BTS_MAXLEVEL			20		// Highest starting level clients offer
+
+#include <string>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <fstream>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <memory>
+#include <vector>
+#include <chrono>
+#include <map>
+#include "resource.h"
+#include "trisengine.h"
+#include "leaderboard.h"
+#include "scorejournal.h"
+
+#if defined(BTS_SQLITE)
+#define BTS_SQL_MODE					// Embedded SQLite high score database available
+#include "SQLiteConnection.h"
+#elif defined(_WIN32)
+#define BTS_SQL_MODE					// ODBC high score database available
+#include "SQLConnection.h"
+#endif
+
+using std::ifstream;
+using std::string;
+using std::mutex;
+using std::lock_guard;
+using std::unique_lock;
+using std::condition_variable;
+using std::thread;
+using std::shared_ptr;
+using std::vector;
+using std::map;
+
+// Score Function Definitions
+class cScorePartition;
+void BTSInitScores(bool database);		// Loads leaderboards and starts score writer
+void BTSCloseScores();					// Writes pending scores and stops writer
+cScorePartition* BTSPartition(int width, int height, int level);	// Finds leaderboard
+cScorePartition* BTSMessagePartition(cScorePartition* partition, string message, int n);
+string BTSScoreList(cScorePartition* partition);	// Forms score list message
+string BTSRankList(cScorePartition* partition, string message);	// Forms rank message
+void BTSSubmitScore(cScorePartition* partition, string message);	// Submits from client
+bool BTSHighScore(cScorePartition* partition, long double score);
+long long BTSEnterScore(const cScoreRecord &record);
+bool BTSRetrieveScores(vector<cScoreRecord> &records);
+bool BTSImportLocalScores(vector<cScoreRecord> &records);
+void BTSBuildScoreList(cScorePartition* partition);
+void BTSWriteScores();
+
+long double BTSCharToLongDouble(char target[]);
+void BTSLongDoubleToChar(char buff[], long double value);
+string BTSParseName(string message, int &n);
+long double BTSParseScore(string message, int &n);
+
+//***************************************************************************************
+//
+//	Class:		cScorePartition
+//	Purpose:	Leaderboard of one combination of board size and starting level,
+//				with its top entries prepared as a score list message. Partitions
+//				live until BTSCloseScores, so rooms keep pointers to theirs.
+//
+//***************************************************************************************
+class cScorePartition
+{
+public:
+	cScorePartition(int width, int height, int level): mWidth(width), mHeight(height),
+		mLevel(level) {}
+
+	cLeaderboard mBoard;					// Guarded by mScoreLock
+	shared_ptr<const string> mMessage;		// Read and replaced atomically
+	int mWidth;
+	int mHeight;
+	int mLevel;
+};
+
+// Global Variables
+mutex mScoreLock;						// Serializes leaderboard access between rooms
+map<long long, cScorePartition*> mPartitions;	// By BTSPartitionKey
+bool mDBMode;							// Database mode (off for local score storage)
+bool mScoresLoaded;						// Flags leaderboards read from storage
+
+// Score writer: persists submissions off the room threads
+#ifdef BTS_SQL_MODE
+cSQLConnection mDatabase;				// Used only by the writer once it runs
+#endif
+cScoreJournal mJournal;					// Local data mode storage, likewise
+thread mScoreWriter;
+mutex mWriteLock;						// Guards the members below
+condition_variable mWriteSignal;
+vector<cScoreRecord> mPendingScores;	// Submissions not yet stored
+bool mWriterStop;
+
+inline long long BTSPartitionKey(int width, int height, int level)
+	{ return ((long long)level << 16) | (height << 8) | width; }
+
+//***************************************************************************************
+//
+//	Function:	BTSInitScores
+//	Purpose:	Selects score storage, reads every stored score from it once and
+//				starts the writer thread. From then on the leaderboards in memory
+//				are authoritative and storage only receives submissions.
+//
+//***************************************************************************************
+void BTSInitScores(bool database)
+{
+	vector<cScoreRecord> records;
+
+#ifdef BTS_SQL_MODE
+	mDBMode = database;
+#else
+	(void)database;
+	mDBMode = false;							// Only local data mode is available
+#endif
+
+	bool error = BTSRetrieveScores(records);
+
+	{
+		lock_guard<mutex> guard(mScoreLock);
+
+		for(unsigned int i(0); i < records.size(); i++)
+			BTSEnterScore(records[i]);
+
+		mScoresLoaded = !error || !mDBMode;	// A missing local file is an empty list
+
+		for(map<long long, cScorePartition*>::iterator i = mPartitions.begin();
+			i != mPartitions.end(); i++)
+			BTSBuildScoreList(i->second);
+	}
+
+	mWriterStop = false;
+	mScoreWriter = thread(BTSWriteScores);
+}
+
+//***************************************************************************************
+//
+//	Function:	BTSCloseScores
+//	Purpose:	Stops the writer once it has stored every pending submission and
+//				frees the leaderboards. No room may be left running.
+//
+//***************************************************************************************
+void BTSCloseScores()
+{
+	{
+		lock_guard<mutex> guard(mWriteLock);
+		mWriterStop = true;
+	}
+	mWriteSignal.notify_one();
+
+	if(mScoreWriter.joinable())
+		mScoreWriter.join();
+
+#ifdef BTS_SQL_MODE
+	mDatabase.disconnect();
+#endif
+	mJournal.close();
+
+	lock_guard<mutex> guard(mScoreLock);
+
+	for(map<long long, cScorePartition*>::iterator i = mPartitions.begin();
+		i != mPartitions.end(); i++)
+		delete i->second;
+	mPartitions.clear();
+}
+
+//***************************************************************************************
+//
+//	Function:	BTSPartition
+//	Purpose:	Finds the leaderboard of a board size and starting level, creating
+//				an empty one if no score has been entered for them yet
+//	Return:		Partition; valid until BTSCloseScores
+//
+//***************************************************************************************
+cScorePartition* BTSPartition(int width, int height, int level)
+{
+	lock_guard<mutex> guard(mScoreLock);
+
+	cScorePartition* &partition = mPartitions[BTSPartitionKey(width, height, level)];
+
+	if(!partition)
+	{
+		partition = new cScorePartition(width, height, level);
+		BTSBuildScoreList(partition);
+	}
+
+	return partition;
+}
+
+//***************************************************************************************
+//
+//	Function:	BTSMessagePartition
+//	Purpose:	Finds the leaderboard named by the board settings a client appends
+//				to a score message at position n: width, height and starting
+//				level, one byte each. Messages from clients that send no settings,
+//				or settings no board can have, keep the given partition.
+//	Return:		Partition; valid until BTSCloseScores
+//
+//***************************************************************************************
+cScorePartition* BTSMessagePartition(cScorePartition* partition, string message, int n)
+{
+	if((int)message.length() < n + 3)
+		return partition;
+
+	int width = message[n] - NUMERAL_OFFSET;
+	int height = message[n + 1] - NUMERAL_OFFSET;
+	int level = message[n + 2] - NUMERAL_OFFSET;
+
+	if(width < 4 || width > BOARD_MAX_WIDTH || height < 6 || height > BOARD_MAX_HEIGHT
+		|| level < 0 || level > BTS_MAXLEVEL)
+		return partition;
+
+	return BTSPartition(width, height, level);
+}
+
+//***************************************************************************************
+//
+//	Function:	BTSScoreList
+//	Purpose:	Hands out the prepared high score list message of a leaderboard.
+//				Takes no lock and does no I/O, so rooms can answer requests from
+//				the game loop.
+//	Return:		Score list message
+//
+//***************************************************************************************
+string BTSScoreList(cScorePartition* partition)
+{
+	shared_ptr<const string> message = atomic_load(&partition->mMessage);
+
+	return *message;
+}
+
+//***************************************************************************************
+//
+//	Function:	BTSBuildScoreList
+//	Purpose:	Forms high score list message for clients from the top of a
+//				leaderboard and publishes it. Caller holds mScoreLock.
+//
+//***************************************************************************************
+void BTSBuildScoreList(cScorePartition* partition)
+{
+	int x;
+	char buff[255];
+	string names[BTS_LISTLENGTH];
+	long double scores[BTS_LISTLENGTH];
+
+	string message;
+	message += S_GLOBAL * 8 + BT_CODE * 32;
+	message += M_SCORE_LIST;
+
+	if(!mScoresLoaded)
+		message += M_SCORE_LIST_FAILURE;
+	else
+	{
+		message += M_SCORE_LIST_SUCCESS;
+
+		int found = partition->mBoard.page(1, BTS_LISTLENGTH, names, scores);
+
+		for(int i(0); i < BTS_LISTLENGTH; i++)
+		{
+			if(i >= found)							// Clients expect a full list
+			{
+				names[i] = "No Entry";
+				scores[i] = 0;
+			}
+
+			message += names[i];
+
+			for(x = names[i].length(); x < NAME_LENGTH; x++)
+			{
+				message += EMPTY_CHARACTER;
+			}
+
+			BTSLongDoubleToChar(buff, scores[i]);
+			message += buff;
+		}
+	}
+
+	atomic_store(&partition->mMessage, shared_ptr<const string>(new string(message)));
+}
+
+//***************************************************************************************
+//
+//	Function:	BTSRankList
+//	Purpose:	Answers a rank request: the player's rank, then a page of the
+//				leaderboard around the player's entry, led by the rank of its
+//				first entry. Fails if the player has no entry.
+//	Return:		Rank list message
+//
+//***************************************************************************************
+string BTSRankList(cScorePartition* partition, string message)
+{
+	int n(2);
+	int found;
+	long long first, rank;
+	char buff[255];
+	string names[BTS_LISTLENGTH];
+	long double scores[BTS_LISTLENGTH];
+
+	string name = BTSParseName(message, n);
+
+	{
+		lock_guard<mutex> guard(mScoreLock);
+
+		rank = partition->mBoard.rank(name);
+		first = partition->mBoard.around(name, BTS_LISTLENGTH, names, scores, found);
+	}
+
+	string reply;
+	reply += S_GLOBAL * 8 + BT_CODE * 32;
+	reply += M_RANK_LIST;
+
+	if(rank == LEADERBOARD_NORANK)
+		reply += M_SCORE_LIST_FAILURE;
+	else
+	{
+		reply += M_SCORE_LIST_SUCCESS;
+
+		BTSLongDoubleToChar(buff, rank);
+		reply += buff;
+		BTSLongDoubleToChar(buff, first);
+		reply += buff;
+
+		for(int i(0); i < found; i++)
+		{
+			reply += names[i];
+
+			for(int x = names[i].length(); x < NAME_LENGTH; x++)
+			{
+				reply += EMPTY_CHARACTER;
+			}
+
+			BTSLongDoubleToChar(buff, scores[i]);
+			reply += buff;
+		}
+	}
+
+	return reply;
+}
+
+//***************************************************************************************
+//
+//	Function:	BTSSubmitScore
+//	Purpose:	Enters a high score pair in a leaderboard and queues it for the
+//				writer. Scores that do not improve on the player's entry are not
+//				stored. The score list message is rebuilt only if the top of the
+//				leaderboard changed.
+//
+//***************************************************************************************
+void BTSSubmitScore(cScorePartition* partition, string message)
+{
+	int n(2);
+
+	string name = BTSParseName(message, n);
+	long double score = BTSParseScore(message, n);
+
+	if(name.empty())
+		return;
+
+	{
+		lock_guard<mutex> guard(mScoreLock);
+
+		long long rank = partition->mBoard.submit(name, score);
+
+		if(rank == LEADERBOARD_NORANK)
+			return;
+
+		if(rank <= BTS_LISTLENGTH)
+			BTSBuildScoreList(partition);
+	}
+
+	{
+		lock_guard<mutex> guard(mWriteLock);
+		mPendingScores.push_back(cScoreRecord(name, score, partition->mWidth,
+			partition->mHeight, partition->mLevel));
+	}
+	mWriteSignal.notify_one();
+}
+
+//***************************************************************************************
+//
+//	Function:	BTSHighScore
+//	Purpose:	Checks whether a score would appear on a leaderboard's score list
+//	Return:		True if it would
+//
+//***************************************************************************************
+bool BTSHighScore(cScorePartition* partition, long double score)
+{
+	lock_guard<mutex> guard(mScoreLock);
+
+	return score > partition->mBoard.score(BTS_LISTLENGTH);
+}
+
+//***************************************************************************************
+//
+//	Function:	BTSEnterScore
+//	Purpose:	Enters a stored score in the leaderboard of its partition, creating
+//				the partition if needed. Caller holds mScoreLock.
+//	Return:		Rank of the entry; LEADERBOARD_NORANK if it did not improve
+//
+//***************************************************************************************
+long long BTSEnterScore(const cScoreRecord &record)
+{
+	cScorePartition* &partition =
+		mPartitions[BTSPartitionKey(record.mWidth, record.mHeight, record.mLevel)];
+
+	if(!partition)
+		partition = new cScorePartition(record.mWidth, record.mHeight, record.mLevel);
+
+	return partition->mBoard.submit(record.mName, record.mScore);
+}
+
+//***************************************************************************************
+//
+//	Function:	BTSWriteScores
+//	Purpose:	Writer thread body. Sleeps until submissions arrive, lets more
+//				gather for BTS_WRITEBATCH ms, then stores them all at once: one
+//				transaction in database mode, one synced journal append in local
+//				data mode, compacting the journal when due. A batch that fails
+//				to store goes back to the front of the queue and is retried
+//				after a delay that doubles up to BTS_RETRYLIMIT. Exits when
+//				stopped and nothing is pending, giving up on a failing batch.
+//
+//***************************************************************************************
+void BTSWriteScores()
+{
+	vector<cScoreRecord> batch;
+	bool stopping(false);
+	bool failed;
+	int delay(0);								// Back-off after a failed write
+
+	while(!stopping)
+	{
+		{
+			unique_lock<mutex> guard(mWriteLock);
+			std::chrono::steady_clock::time_point retry =
+				std::chrono::steady_clock::now() + std::chrono::milliseconds(delay);
+
+			while(!mWriterStop && delay > 0 &&
+				mWriteSignal.wait_until(guard, retry) == std::cv_status::no_timeout)
+			{}
+
+			while(mPendingScores.empty() && !mWriterStop)
+				mWriteSignal.wait(guard);
+
+			if(!mWriterStop && delay == 0)		// Gather the rest of a burst
+				mWriteSignal.wait_for(guard, std::chrono::milliseconds(BTS_WRITEBATCH));
+
+			batch.swap(mPendingScores);
+			stopping = mWriterStop;
+		}
+
+		if(batch.empty())
+			continue;
+
+		failed = false;
+
+#ifdef BTS_SQL_MODE
+		if(mDBMode)
+		{
+			vector<cScoreRecord> records;
+
+			failed = mDatabase.submitScores(batch);
+
+			if(!mScoresLoaded && !mDatabase.retrieveScores(records))
+			{
+				lock_guard<mutex> guard(mScoreLock);	// Database back: merge its scores
+
+				for(unsigned int i(0); i < records.size(); i++)
+					BTSEnterScore(records[i]);
+
+				mScoresLoaded = true;
+
+				for(map<long long, cScorePartition*>::iterator i = mPartitions.begin();
+					i != mPartitions.end(); i++)
+					BTSBuildScoreList(i->second);
+			}
+		}
+		else
+#endif
+		{
+			failed = mJournal.append(batch);
+
+			if(!failed && mJournal.due())
+				mJournal.compact();
+		}
+
+		if(failed && !stopping)					// Requeue ahead of newer scores
+		{
+			lock_guard<mutex> guard(mWriteLock);
+			mPendingScores.insert(mPendingScores.begin(), batch.begin(), batch.end());
+			delay = (delay == 0) ? BTS_RETRYDELAY :
+				(delay * 2 > BTS_RETRYLIMIT) ? BTS_RETRYLIMIT : delay * 2;
+		}
+		else
+		{
+			if(failed)
+				printf("%d high scores could not be stored\n", (int)batch.size());
+			delay = 0;
+		}
+
+		batch.clear();
+	}
+}
+
+//***************************************************************************************
+//
+//	Function:	BTSRetrieveScores
+//	Purpose:	Reads every stored score, oldest first. In local data mode a server
+//				with no journal yet imports the text score file once, sealing its
+//				scores into the first snapshot before the journal is created, so
+//				a crash in between cannot lose the import.
+//	Return:		True if error occurs
+//
+//***************************************************************************************
+bool BTSRetrieveScores(vector<cScoreRecord> &records)
+{
+	bool error(false);
+
+	records.clear();
+
+#ifdef BTS_SQL_MODE
+	if(mDBMode)
+		error = mDatabase.retrieveScores(records);
+	else
+#endif
+	{
+		vector<cScoreRecord> imported;
+
+		if(!mJournal.exists() && !BTSImportLocalScores(imported) && !imported.empty()
+			&& mJournal.compact(imported))
+		{
+			records.swap(imported);				// Import is tried again next start
+			return true;
+		}
+
+		error = mJournal.open(records);
+	}
+
+	return error;
+}
+
+//***************************************************************************************
+//
+//	Function:	BTSImportLocalScores
+//	Purpose:	Reads the text score file of earlier servers. Each score takes
+//				three lines: name, score, then checksum, followed by width, height
+//				and starting level in files written since leaderboards were
+//				partitioned; scores without them count for the default board.
+//	Return:		True if error occurs
+//
+//***************************************************************************************
+bool BTSImportLocalScores(vector<cScoreRecord> &records)
+{
+	bool error(false);
+	char buff[256];
+	cScoreRecord record;
+	int checksum;
+
+	ifstream scorefile;
+	scorefile.open(BT_SERVER_SCOREFILE);
+	if(scorefile)
+	{
+		while(scorefile.getline(buff, 256))
+		{
+			record.mName = buff;
+			scorefile.getline(buff, 256);
+			record.mScore = BTSCharToLongDouble(buff);
+			if(!scorefile.getline(buff, 256))
+				break;
+
+			record.mWidth = BOARDWIDTH;
+			record.mHeight = BOARDDEPTH;
+			record.mLevel = 0;
+			checksum = atoi(buff);
+			sscanf(buff, "%*d %d %d %d", &record.mWidth, &record.mHeight, &record.mLevel);
+
+			if(!(record.mName == "No Entry" && record.mScore == 0) &&
+				BTChecksum(record.mName, record.mScore) == checksum)
+				records.push_back(record);
+		}
+	}
+	else
+		error = true;
+	scorefile.close();
+
+	return error;
+}
+
+//***************************************************************************************
+//
+//	Function:	BTSParseName
+//	Purpose:	Parses a name from the server score list message
+//	Return:		String containing player name
+//
+//***************************************************************************************
+string BTSParseName(string message, int &n)
+{
+	string name;
+
+	for(int i(0); i < NAME_LENGTH && n < message.length(); i++, n++)
+	{
+		if(message[n] != EMPTY_CHARACTER)
+			name += message[n];
+	}
+
+	return name;
+}
+
+//***************************************************************************************
+//
+//	Function:	BTSParseScore
+//	Purpose:	Parses a score from the server score list message
+//	Return:		long double containing high score
+//
+//***************************************************************************************
+long double BTSParseScore(string message, int &n)
+{
+	char score[SCORE_LENGTH + 1];
+
+	for(int i(0); i < SCORE_LENGTH && n < message.length(); i++, n++)
+		score[i] = message[n];
+
+	return BTSCharToLongDouble(score);
+}
+
+//***************************************************************************************
+//
+//	Function:	BTSCharToLongDouble
+//	Purpose:	Converts number within character array to long double
+//
+//***************************************************************************************
+long double BTSCharToLongDouble(char target[])
+{
+	long double num(0);
+	long double digit;
+	int i(0);
+
+	for(i = 0; target[i] >= 48 && target[i] <= 57; i++)
+	{
+		num = num * 10;
+		digit = target[i] - 48;
+		num += digit;
+	}
+
+	return num;
+}
+
+//***************************************************************************************
+//
+//	Function:	BTSLongDoubleToChar
+//	Purpose:	Converts a long double to a character array of size SCORE_LENGTH
+//
+//***************************************************************************************
+void BTSLongDoubleToChar(char result[], long double value)
+{
+	char buff[SCORE_LENGTH + 1];
+	long double divisor(1);
+	int i;
+
+	for(i = 0; i < SCORE_LENGTH - 1; i++)
+		divisor = divisor * 10;
+
+	for(i = 0; i < SCORE_LENGTH; i++)
+	{
+		buff[i] = ((int)(value / divisor)) + 48;	// Shave off digit, convert to ascii
+		value = value - ((buff[i] - 48) * divisor);	// Remove digit from value
+		divisor = divisor / 10;				// Shift divisor to next digit
+	}
+
+	buff[SCORE_LENGTH] = '\0';				// Null terminate string
+	sprintf(result, buff);							// Return result
+}
@@ -1,12 +1,33 @@
-delete from scores
+if object_id('scores') is null
+	create table scores
+	(
+		id		int identity(1, 1) primary key,
+		player	varchar(9) not null,
+		score	bigint not null,
+		width	int not null default 10,
+		height	int not null default 22,
+		level	int not null default 0
+	)
+else if col_length('scores', 'width') is null
+begin
+	-- Top-ten table of earlier servers: ids 0 to 9 in rank order, no board
+	-- settings. Its scores move into the new table on the default board.
+	exec sp_rename 'scores', 'scores_old'
 
-insert into scores values ( 0, 'No Entry', 0 )
-insert into scores values ( 1, 'No Entry', 0 )
-insert into scores values ( 2, 'No Entry', 0 )
-insert into scores values ( 3, 'No Entry', 0 )
-insert into scores values ( 4, 'No Entry', 0 )
-insert into scores values ( 5, 'No Entry', 0 )
-insert into scores values ( 6, 'No Entry', 0 )
-insert into scores values ( 7, 'No Entry', 0 )
-insert into scores values ( 8, 'No Entry', 0 )
-insert into scores values ( 9, 'No Entry', 0 )
+	create table scores
+	(
+		id		int identity(1, 1) primary key,
+		player	varchar(9) not null,
+		score	bigint not null,
+		width	int not null default 10,
+		height	int not null default 22,
+		level	int not null default 0
+	)
+
+	insert into scores (player, score)
+		select rtrim(player), score from scores_old
+		where not (player = 'No Entry' and score = 0)
+		order by id
+
+	drop table scores_old
+end
@@ -18,7 +18,10 @@
 #include <sql.h>
 #include <sqlext.h>
 #include <string>
+#include <vector>
+#include "leaderboard.h"
 using std::string;
+using std::vector;
 
 #define DATABASE_NAME "bluetetris"
 #define USER_NAME "btserver"
@@ -42,8 +45,8 @@ public:
 
 	bool connected() { return mConnected; }
 
-	bool submitScore(const char* name, long double score);		// Submits score to database
-	bool retrieveTable(string names[], long double scores[]);	// Retrieves lists from db
+	bool submitScores(const vector<cScoreRecord> &records);	// Submits batch of scores
+	bool retrieveScores(vector<cScoreRecord> &records);		// Retrieves every score
 
 private:
 
@@ -56,167 +59,135 @@ private:
 
 //***************************************************************************************
 //
-//	Function:	retrieveTable
-//	Purpose:	Retrieves high score table
+//	Function:	retrieveScores
+//	Purpose:	Retrieves every stored score in the order they were submitted
+//	Return:		True if error occurs
 //
 //***************************************************************************************
-bool cSQLConnection::retrieveTable(string names[], long double scores[])
+bool cSQLConnection::retrieveScores(vector<cScoreRecord> &records)
 {
 	char name[NAME_LENGTH + 1];
-	unsigned long score;
-	char query[512];
-	bool inserted;
+	SQLBIGINT score;
+	SQLINTEGER width, height, level;
 	bool terminated;
 	bool error(false);
-	int i, n;
-	int errorCounter(0);
-	SDWORD cbQual;
+	int i;
+	SQLLEN cbQual;
+	SQLRETURN result;
+
+	records.clear();
 
 	if(!mConnected)
 		connect();
 
 	if(mConnected)
 	{
-		for(n = 0; n < 10; n++)			// Clear values in arrays
-		{
-			names[n] = "No Entry";
-			scores[n] = 0;
-		}
-
-		for(n = 0; n < 10; n++)			// Draw 10 values from database
+		SQLAllocHandle(SQL_HANDLE_STMT, hdbc, &hstmt);						// Allocate handle
+		result = SQLExecDirect(hstmt,
+			(unsigned char *)"select player, score, width, height, level from scores order by id",
+			SQL_NTS);
+		SQLBindCol(hstmt, 1, SQL_C_CHAR, name, NAME_LENGTH + 1, &cbQual);	// Bind Data
+		SQLBindCol(hstmt, 2, SQL_C_SBIGINT, &score, 0, &cbQual);
+		SQLBindCol(hstmt, 3, SQL_C_SLONG, &width, 0, &cbQual);
+		SQLBindCol(hstmt, 4, SQL_C_SLONG, &height, 0, &cbQual);
+		SQLBindCol(hstmt, 5, SQL_C_SLONG, &level, 0, &cbQual);
+
+		if(!SQL_SUCCEEDED(result))
+			error = true;
+
+		while(!error && SQL_SUCCEEDED(result = SQLFetch(hstmt)))			// Retrieve Data
 		{
-			SQLAllocHandle(SQL_HANDLE_STMT, hdbc, &hstmt);						 // Allocate handle
-			sprintf(query, "select player, score from scores where id = %i", n); // Form query
-			SQLExecDirect(hstmt, (unsigned char *)query, SQL_NTS);				 // Execute query
-			SQLBindCol(hstmt, 1, SQL_CHAR, name, NAME_LENGTH + 1, &cbQual);					 // Bind Data
-			SQLBindCol(hstmt, 2, SQL_INTEGER, &score, SCORE_LENGTH, &cbQual);
-
-			if(SQLFetch(hstmt) != SQL_ERROR)									 // Retrieve Data
+			terminated = false;
+			for(i = NAME_LENGTH; i > 0 && !terminated; i--)		// Trim padding
 			{
-				inserted = false;
-				terminated = false;
-				for(i = NAME_LENGTH; i > 0 && !terminated; i--)
-				{
-					if(name[i-1] != ' ')
-					{
-						name[i] = '\0';
-						terminated = true;
-					}
-				}
-
-				for(i = 9; i > 0 && !inserted; i--)
-				{
-					if(score <= scores[i - 1])		// If position found
-					{
-						scores[i] = score;			// Insert score
-						names[i] = name;
-						inserted = true;
-					}
-					else							// Else
-					{
-						scores[i] = scores[i - 1];	// Shift next score down
-						names[i] = names[i - 1];
-					}
-				}
-
-				if(!inserted)						// If loop is exited, score is first
+				if(name[i-1] != ' ')
 				{
-					scores[0] = score;
-					names[0] = name;
+					name[i] = '\0';
+					terminated = true;
 				}
 			}
-			else
-				errorCounter++;
+			if(!terminated)
+				name[0] = '\0';
 
-			SQLFreeHandle(SQL_HANDLE_STMT, hstmt);
+			records.push_back(cScoreRecord(name, (long double)score, width, height, level));
 		}
+
+		if(result != SQL_NO_DATA)
+			error = true;
+
+		SQLFreeHandle(SQL_HANDLE_STMT, hstmt);
 	}
 	else
 		error = true;
 
-	if(errorCounter == 10)			// If no entries found successfully
-		error = true;				// Query failed =(
-
 	return error;
 }
 
 //***************************************************************************************
 //
-//	Function:	submitScore
-//	Purpose:	Submits name and score pair to the database
+//	Function:	submitScores
+//	Purpose:	Adds a batch of scores to the database in one transaction. Names
+//				are passed as parameters, never formatted into the query.
+//	Return:		True if any submission fails; nothing is written then
 //
 //***************************************************************************************
-bool cSQLConnection::submitScore(const char* newName, long double newScore)
+bool cSQLConnection::submitScores(const vector<cScoreRecord> &records)
 {
-	static bool mutex(false);
-
 	bool error(false);
-	int n(0);
 	char name[NAME_LENGTH + 1];
-	unsigned long score;
-	int index;
-	char query[255];
-	SDWORD cbQual;
-	unsigned int timeout(0);
-
-	int ids[10];
-	string names[10];
-	unsigned long scores[10];
+	SQLBIGINT score;
+	SQLINTEGER width, height, level;
+	SQLLEN nameLength;
 
 	if(!mConnected)			// If not connected
 		connect();			// Attempt to connect
 
-	while(mutex);			// Spinlock
-
-	if(mConnected)			// If connected, submit query
+	if(mConnected)			// If connected, submit queries
 	{
-		mutex = true;
-
-		for(int i(0); i < 10; i++)	// Retrieve current contents
+		SQLSetConnectAttr(hdbc, SQL_ATTR_AUTOCOMMIT, (SQLPOINTER)SQL_AUTOCOMMIT_OFF,
+			SQL_IS_UINTEGER);												// Begin transaction
+		SQLAllocHandle(SQL_HANDLE_STMT, hdbc, &hstmt);						// Allocate handle
+		if(!SQL_SUCCEEDED(SQLPrepare(hstmt, (unsigned char *)
+			"insert into scores (player, score, width, height, level) values (?, ?, ?, ?, ?)",
+			SQL_NTS)))
+			error = true;
+		SQLBindParameter(hstmt, 1, SQL_PARAM_INPUT, SQL_C_CHAR, SQL_VARCHAR, NAME_LENGTH, 0,
+			name, sizeof(name), &nameLength);
+		SQLBindParameter(hstmt, 2, SQL_PARAM_INPUT, SQL_C_SBIGINT, SQL_BIGINT, 0, 0,
+			&score, 0, NULL);
+		SQLBindParameter(hstmt, 3, SQL_PARAM_INPUT, SQL_C_SLONG, SQL_INTEGER, 0, 0,
+			&width, 0, NULL);
+		SQLBindParameter(hstmt, 4, SQL_PARAM_INPUT, SQL_C_SLONG, SQL_INTEGER, 0, 0,
+			&height, 0, NULL);
+		SQLBindParameter(hstmt, 5, SQL_PARAM_INPUT, SQL_C_SLONG, SQL_INTEGER, 0, 0,
+			&level, 0, NULL);
+
+		for(unsigned int i(0); i < records.size() && !error; i++)
 		{
-			SQLAllocHandle(SQL_HANDLE_STMT, hdbc, &hstmt);						 // Allocate handle
-			sprintf(query, "select player, score from scores where id = %i", i); // Form Query
-			SQLExecDirect(hstmt, (unsigned char *)query, SQL_NTS);				 // Execute Query
-			SQLBindCol(hstmt, 1, SQL_CHAR, name, 10, &cbQual);					 // Bind Data
-			SQLBindCol(hstmt, 2, SQL_INTEGER, &score, 10, &cbQual);
-
-			if(SQLFetch(hstmt) != SQL_ERROR)
-			{
-				ids[n] = i;
-				names[n] = name;
-				scores[n] = score;
-				n++;
-			}
-			SQLFreeHandle(SQL_HANDLE_STMT, hstmt);
+			strncpy(name, records[i].mName.c_str(), NAME_LENGTH);
+			name[NAME_LENGTH] = '\0';
+			nameLength = SQL_NTS;
+			score = (SQLBIGINT)records[i].mScore;
+			width = records[i].mWidth;
+			height = records[i].mHeight;
+			level = records[i].mLevel;
+
+			if(!SQL_SUCCEEDED(SQLExecute(hstmt)))
+				error = true;
 		}
 
-		index = 0;
+		SQLFreeHandle(SQL_HANDLE_STMT, hstmt);
 
-		for(int i(1); i < n; i++)		// Find lowest value
-		{
-			if(scores[i] < scores[index])
-				index = i;
-		}
+		if(!error && !SQL_SUCCEEDED(SQLEndTran(SQL_HANDLE_DBC, hdbc, SQL_COMMIT)))
+			error = true;
+		if(error)
+			SQLEndTran(SQL_HANDLE_DBC, hdbc, SQL_ROLLBACK);
 
-		if(newScore > scores[index] || n == 0)
-		{
-			if(n > 0)					// Remove old score entry
-			{
-				SQLAllocHandle(SQL_HANDLE_STMT, hdbc, &hstmt);						 // Allocate handle
-				sprintf(query, "delete from scores where id = %i", ids[index]);
-				SQLExecDirect(hstmt, (unsigned char *)query, SQL_NTS);
-				SQLFreeHandle(SQL_HANDLE_STMT, hstmt);
-			}
-			else
-				ids[index] = 0;
-										// Insert new score entry with same index
-			SQLAllocHandle(SQL_HANDLE_STMT, hdbc, &hstmt);						 // Allocate handle
-			sprintf(query, "insert into scores values ( %i, '%s', %.0Lf );", ids[index], newName, newScore);
-			SQLExecDirect(hstmt, (unsigned char *)query, SQL_NTS);
-			SQLFreeHandle(SQL_HANDLE_STMT, hstmt);
-		}
+		SQLSetConnectAttr(hdbc, SQL_ATTR_AUTOCOMMIT, (SQLPOINTER)SQL_AUTOCOMMIT_ON,
+			SQL_IS_UINTEGER);
 
-		mutex = false;
+		if(error)			// Reconnect before the batch is retried
+			disconnect();
 	}
 	else
 		error = true;
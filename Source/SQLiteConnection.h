@@ -0,0 +1,258 @@
+//***************************************************************************************
+//
+//	Date Created:	October 17, 2026
+//	File:			SQLiteConnection.h
+//	Project:		Blue Tetris
+//
+//	Purpose:		Embedded SQLite high score database. Offers the interface of the
+//					ODBC cSQLConnection, so the server uses either one unchanged.
+//					Statements are prepared once per connection and reused; values
+//					are bound, never formatted into SQL. The table holds every score
+//					that improved a player's leaderboard entry, in order.
+//
+//***************************************************************************************
+
+#pragma once
+
+#include <sqlite3.h>
+#include <string>
+#include <vector>
+#include "resource.h"
+#include "trisengine.h"
+#include "leaderboard.h"
+using std::string;
+using std::vector;
+
+#define SQLITE_DATABASE		"Data/serverscores.db"
+#define SQLITE_BUSYTIME		1000		// Milliseconds to wait for another writer
+
+//***************************************************************************************
+//
+//	Class:			cSQLConnection
+//	Purpose:		Connection to the Blue Tetris high score database, kept in a
+//					local SQLite file in write-ahead log mode
+//
+//***************************************************************************************
+class cSQLConnection
+{
+public:
+	cSQLConnection(): mDatabase(NULL), mSelectAll(NULL), mInsert(NULL), mBegin(NULL),
+		mCommit(NULL), mRollback(NULL), mConnected(false) {}
+	~cSQLConnection() { disconnect(); }
+
+	bool connect();			// Opens database; true if connected
+	void disconnect();		// Closes database
+
+	bool connected() { return mConnected; }
+
+	bool submitScores(const vector<cScoreRecord> &records);	// Submits batch of scores
+	bool retrieveScores(vector<cScoreRecord> &records);		// Retrieves every score
+
+private:
+
+	cSQLConnection(const cSQLConnection&);			// Not copyable
+	cSQLConnection& operator=(const cSQLConnection&);
+
+	bool prepare(sqlite3_stmt* &statement, const char* sql);	// Prepares cached statement
+	bool step(sqlite3_stmt* statement);			// Runs statement that returns no rows
+
+	sqlite3* mDatabase;
+	sqlite3_stmt* mSelectAll;					// Every score, oldest first
+	sqlite3_stmt* mInsert;						// Adds one score
+	sqlite3_stmt* mBegin;						// Transaction control
+	sqlite3_stmt* mCommit;
+	sqlite3_stmt* mRollback;
+
+	bool mConnected;
+};
+
+//***************************************************************************************
+//
+//	Function:	retrieveScores
+//	Purpose:	Retrieves every stored score in the order they were submitted, so
+//				replaying them rebuilds the leaderboards with their tie order
+//	Return:		True if error occurs
+//
+//***************************************************************************************
+inline bool cSQLConnection::retrieveScores(vector<cScoreRecord> &records)
+{
+	bool error(false);
+	int result;
+	cScoreRecord record;
+
+	records.clear();
+
+	if(!mConnected)
+		connect();
+
+	if(!mConnected)
+		return true;
+
+	while((result = sqlite3_step(mSelectAll)) == SQLITE_ROW)
+	{
+		const unsigned char* name = sqlite3_column_text(mSelectAll, 0);
+
+		record.mName = name ? string((const char*)name).substr(0, NAME_LENGTH) : string();
+		record.mScore = (long double)sqlite3_column_int64(mSelectAll, 1);
+		record.mWidth = sqlite3_column_int(mSelectAll, 2);
+		record.mHeight = sqlite3_column_int(mSelectAll, 3);
+		record.mLevel = sqlite3_column_int(mSelectAll, 4);
+		records.push_back(record);
+	}
+
+	if(result != SQLITE_DONE)
+		error = true;
+
+	sqlite3_reset(mSelectAll);
+
+	return error;
+}
+
+//***************************************************************************************
+//
+//	Function:	submitScores
+//	Purpose:	Adds a batch of scores in one transaction
+//	Return:		True if error occurs; nothing is written then
+//
+//***************************************************************************************
+inline bool cSQLConnection::submitScores(const vector<cScoreRecord> &records)
+{
+	bool error(false);
+
+	if(!mConnected)
+		connect();
+
+	if(!mConnected)
+		return true;
+
+	error = step(mBegin);
+
+	for(unsigned int i(0); i < records.size() && !error; i++)
+	{
+		if(records[i].mScore < 0)
+			continue;
+
+		sqlite3_bind_text(mInsert, 1, records[i].mName.c_str(), -1, SQLITE_TRANSIENT);
+		sqlite3_bind_int64(mInsert, 2, (sqlite3_int64)records[i].mScore);
+		sqlite3_bind_int(mInsert, 3, records[i].mWidth);
+		sqlite3_bind_int(mInsert, 4, records[i].mHeight);
+		sqlite3_bind_int(mInsert, 5, records[i].mLevel);
+		error = step(mInsert);
+		sqlite3_clear_bindings(mInsert);
+	}
+
+	if(!error)
+		error = step(mCommit);
+
+	if(error)
+		step(mRollback);
+
+	return error;
+}
+
+//***************************************************************************************
+//
+//	Function:	connect
+//	Purpose:	Opens database file, creating the score table if needed, switches
+//				to write-ahead logging and prepares every statement. Tables made
+//				before leaderboards were partitioned gain the board columns; their
+//				scores count for the default board.
+//	Return:		True if connected
+//
+//***************************************************************************************
+inline bool cSQLConnection::connect()
+{
+	if(mConnected)
+		return true;
+
+	if(sqlite3_open(SQLITE_DATABASE, &mDatabase) != SQLITE_OK)
+	{
+		disconnect();
+		return false;
+	}
+
+	sqlite3_busy_timeout(mDatabase, SQLITE_BUSYTIME);
+
+	// Write-ahead log: readers never wait on the writer, and a commit is one
+	// sequential append. NORMAL sync keeps the database consistent after a crash.
+	char columns[3][96];
+	sprintf(columns[0], "width integer not null default %d", BOARDWIDTH);
+	sprintf(columns[1], "height integer not null default %d", BOARDDEPTH);
+	sprintf(columns[2], "level integer not null default 0");
+
+	bool error = sqlite3_exec(mDatabase,
+		"pragma journal_mode = wal;"
+		"pragma synchronous = normal;"
+		"create table if not exists scores ("
+			"id integer primary key, player text not null, score integer not null);"
+		"drop index if exists scores_rank;",
+		NULL, NULL, NULL) != SQLITE_OK;
+
+	for(int i(0); i < 3 && !error; i++)			// Fails harmlessly if column exists
+		sqlite3_exec(mDatabase, (string("alter table scores add column ") + columns[i]).c_str(),
+			NULL, NULL, NULL);
+
+	error = error || prepare(mSelectAll,
+		"select player, score, width, height, level from scores order by id");
+	error = error || prepare(mInsert,
+		"insert into scores (player, score, width, height, level) values (?1, ?2, ?3, ?4, ?5)");
+	error = error || prepare(mBegin, "begin immediate");
+	error = error || prepare(mCommit, "commit");
+	error = error || prepare(mRollback, "rollback");
+
+	mConnected = !error;
+	if(error)
+		disconnect();
+
+	return mConnected;
+}
+
+//***************************************************************************************
+//
+//	Function:	disconnect
+//	Purpose:	Finalizes cached statements and closes database
+//
+//***************************************************************************************
+inline void cSQLConnection::disconnect()
+{
+	sqlite3_stmt** statements[] = { &mSelectAll, &mInsert, &mBegin, &mCommit, &mRollback };
+
+	for(unsigned int i(0); i < sizeof(statements) / sizeof(statements[0]); i++)
+	{
+		sqlite3_finalize(*statements[i]);			// Accepts NULL
+		*statements[i] = NULL;
+	}
+
+	if(mDatabase)
+		sqlite3_close(mDatabase);
+
+	mDatabase = NULL;
+	mConnected = false;
+}
+
+//***************************************************************************************
+//
+//	Function:	prepare
+//	Purpose:	Compiles statement for reuse over the connection's lifetime
+//	Return:		True if error occurs
+//
+//***************************************************************************************
+inline bool cSQLConnection::prepare(sqlite3_stmt* &statement, const char* sql)
+{
+	return sqlite3_prepare_v2(mDatabase, sql, -1, &statement, NULL) != SQLITE_OK;
+}
+
+//***************************************************************************************
+//
+//	Function:	step
+//	Purpose:	Runs a cached statement that returns no rows and resets it
+//	Return:		True if error occurs
+//
+//***************************************************************************************
+inline bool cSQLConnection::step(sqlite3_stmt* statement)
+{
+	bool error = sqlite3_step(statement) != SQLITE_DONE;
+
+	sqlite3_reset(statement);
+	return error;
+}
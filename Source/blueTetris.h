@@ -15,7 +15,7 @@
 
 #define BT_DATAFILE		"Data/settings.xml"
 #define BT_KEYMAPFILE	"Data/keymap.dat"
-#define BT_SCOREFILE	"Data/scores.dat"
+#define BT_SCOREFILE	"Data/scores.dat"	// Mapped score table; text in earlier versions
 
 #include "singlePlayer.h"
 #include "multiplayer.h"
@@ -30,6 +30,7 @@
 #include "sound.h"
 #include "timer.h"
 #include "XMLVarLibrary.h"
+#include "scorefile.h"
 
 #include <vector>
 using std::vector;
@@ -107,6 +108,9 @@ private:
 	// Data storage to files
 	bool saveSettings();	// Saves options to data file
 	bool loadSettings();	// Loads options from data file
+	bool loadScores();		// Maps local score file and reads list from it
+	void saveScores();		// Writes local score list into mapped file
+	bool importScores();	// Reads local score list from text score file
 
 	long double charToLongDouble(char target[]);
 	void longDoubleToChar(char result[], long double value);
@@ -128,6 +132,7 @@ private:
 	bool readScoreMessage(string message); // Interprets message from server containing score list
 	string parseName(string message, int &n);
 	long double parseScore(string message, int &n);
+	string scoreSettings();	// Board settings naming the server leaderboard
 
 	int mState;				// Global gamestate
 
@@ -175,6 +180,7 @@ private:
 	cTexture mTexture;				// Texture library
 	long double mLocalScores[10];	// Local high score list
 	string mLocalNames[10];			// Names for local score list
+	cScoreFile mScoreFile;			// Mapped local score file
 	long double mServerScores[10];	// Server-wide high score storage
 	string mServerNames[10];		// Names for server score list
 	bool mServerScoresRetrieved;	// Flags when server scores are stored
@@ -336,9 +342,6 @@ void cBlueTetris::display()
 bool cBlueTetris::saveSettings()
 {
 	bool error(false);
-	char buff[256];						// Buffer for output
-	long double score;
-	string name;
 
 	ofstream fout;
 
@@ -366,23 +369,7 @@ bool cBlueTetris::saveSettings()
 		error = true;
 
 	// Save High Score List
-	fout.open(BT_SCOREFILE);
-
-	if(fout)
-	{
-		for(int i(0); i < 10; i++)
-		{
-			score = mLocalScores[i];
-			name = mLocalNames[i];
-
-			sprintf(buff, "%.0Lf", score);
-			fout << name << '\n'
-				 << buff << '\n'
-				 << BTChecksum(name, score) << '\n';
-		}
-
-		fout.close();
-	}
+	saveScores();
 
 	// Save Key Configuration
 	fout.open(BT_KEYMAPFILE);			// Open keymap file
@@ -405,11 +392,8 @@ bool cBlueTetris::saveSettings()
 bool cBlueTetris::loadSettings()
 {
 	bool error(false);
-	char buff[256];
-	string name;
-	long double score;
 	
-	ifstream keyfile, scorefile;
+	ifstream keyfile;
 
 	cXMLLib settings;
 	if(settings.read(BT_DATAFILE))
@@ -434,32 +418,7 @@ bool cBlueTetris::loadSettings()
 	}
 
 	// Load High Score List
-	scorefile.open(BT_SCOREFILE);
-	if(scorefile)
-	{
-		int n(0);
-
-		for(int i(0); i < 10; i++)
-		{
-			scorefile.getline(buff, 256);
-			name = buff;
-			scorefile.getline(buff, 256);
-			score = charToLongDouble(buff);
-			scorefile.getline(buff, 256);
-			int l = BTChecksum(name, score);
-			int m = atoi(buff);
-			if(!(name == "No Entry" && score == 0))
-			{
-				if(BTChecksum(name, score) == atoi(buff))
-				{
-					mLocalNames[n] = name;
-					mLocalScores[n] = score;
-					n++;
-				}
-			}
-		}
-	}
-	scorefile.close();
+	loadScores();
 
 	// Load Key Configuration
 	keyfile.open(BT_KEYMAPFILE);			// Open keymap file
@@ -471,6 +430,108 @@ bool cBlueTetris::loadSettings()
 	return error;
 }
 
+//***************************************************************************************
+//
+//	Function:	loadScores
+//	Purpose:	Maps local score file and reads the list from it. A text score
+//				file from an earlier version is imported once and replaced by a
+//				score table; a damaged table is replaced by an empty one.
+//	Return:		True if no score file could be mapped
+//
+//***************************************************************************************
+bool cBlueTetris::loadScores()
+{
+	string name;
+	long double score;
+	int n(0);
+
+	if(mScoreFile.open(BT_SCOREFILE))			// No usable score table
+	{
+		if(!cScoreFile::marked(BT_SCOREFILE))	// Text file of an earlier version
+			importScores();
+
+		if(mScoreFile.create(BT_SCOREFILE))
+			return true;
+
+		saveScores();
+		return mScoreFile.commit();
+	}
+
+	for(int i(0); i < SCOREFILE_ENTRIES && n < 10; i++)
+	{
+		if(!mScoreFile.read(i, name, score))	// Skips empty and damaged entries
+		{
+			mLocalNames[n] = name;
+			mLocalScores[n] = score;
+			n++;
+		}
+	}
+
+	return false;
+}
+
+//***************************************************************************************
+//
+//	Function:	saveScores
+//	Purpose:	Writes local score list into the mapped score file
+//
+//***************************************************************************************
+void cBlueTetris::saveScores()
+{
+	for(int i(0); i < 10; i++)
+	{
+		if(mLocalNames[i] == "No Entry" && mLocalScores[i] == 0)
+			mScoreFile.write(i, "", 0);
+		else
+			mScoreFile.write(i, mLocalNames[i], mLocalScores[i]);
+	}
+
+	mScoreFile.flush();
+}
+
+//***************************************************************************************
+//
+//	Function:	importScores
+//	Purpose:	Reads local score list from a text score file: name, score and
+//				checksum lines for each entry
+//	Return:		True if file could not be read
+//
+//***************************************************************************************
+bool cBlueTetris::importScores()
+{
+	char buff[256];
+	string name;
+	long double score;
+	ifstream scorefile;
+
+	scorefile.open(BT_SCOREFILE);
+	if(!scorefile)
+		return true;
+
+	int n(0);
+
+	for(int i(0); i < 10; i++)
+	{
+		scorefile.getline(buff, 256);
+		name = buff;
+		scorefile.getline(buff, 256);
+		score = charToLongDouble(buff);
+		scorefile.getline(buff, 256);
+		if(!(name == "No Entry" && score == 0))
+		{
+			if(BTChecksum(name, score) == atoi(buff))
+			{
+				mLocalNames[n] = name;
+				mLocalScores[n] = score;
+				n++;
+			}
+		}
+	}
+
+	scorefile.close();
+	return false;
+}
+
 //***************************************************************************************
 //
 //	Function:	charToLongDouble
@@ -995,7 +1056,13 @@ void cBlueTetris::sendScoreRequest()
 {
 	if(mConnection)
 	{
-		mConnection->sendMessage(S_GLOBAL, M_REQUEST_SCORE);	// Send a score request
+		string message;
+
+		message += S_GLOBAL * 8 + BT_CODE * 32;	// Identifier byte
+		message += M_REQUEST_SCORE;				// Message byte
+		message += scoreSettings();
+
+		mConnection->enqueue(message);			// Send a score request
 	}
 }
 
@@ -1086,6 +1153,7 @@ void cBlueTetris::sendScore()
 
 	longDoubleToChar(buff, mScore);
 	message += buff;
+	message += scoreSettings();
 
 	mConnection->enqueue(message);
 }
@@ -1113,10 +1181,31 @@ void cBlueTetris::sendScoreSubmit()
 
 	longDoubleToChar(buff, mScore);
 	message += buff;
+	message += scoreSettings();
 
 	mConnection->enqueue(message);
 }
 
+//***************************************************************************************
+//
+//	Function:	scoreSettings
+//	Purpose:	Forms the board width, height and starting level that follow a
+//				score message, so the server files the score with games played
+//				on the same settings
+//	Return:		Settings bytes
+//
+//***************************************************************************************
+string cBlueTetris::scoreSettings()
+{
+	string settings;
+
+	settings += mbx + NUMERAL_OFFSET;
+	settings += mby + NUMERAL_OFFSET;
+	settings += mLevel + NUMERAL_OFFSET;
+
+	return settings;
+}
+
 //***************************************************************************************
 //
 //	Function:	submitScore
@@ -1150,6 +1239,8 @@ void cBlueTetris::submitScore()
 			mLocalScores[0] = mScore;
 			mLocalNames[0] = mName;
 		}
+
+		saveScores();							// Update score file in place
 	}
 }
 
@@ -0,0 +1,273 @@
+//***************************************************************************************
+//
+//	Date Created:	October 17, 2026
+//	File:			boardsync.h
+//	Project:		Blue Tetris
+//
+//	Purpose:		Board resynchronisation shared by the Blue Tetris client and
+//					server. The server remembers the last board image it sent to each
+//					client, and the client keeps the same image as it applied it; a
+//					resync carries only the rows that differ from that image, so its
+//					size follows the size of the discrepancy.
+//
+//					Resync payload:
+//						revision (2 bytes), base revision (2 bytes),
+//						mask of rows present (4 bytes), then for each row present:
+//						occupancy mask (3 bytes) and a run (count, face) for each
+//						stretch of occupied units sharing a face, left to right.
+//					Multi-byte values are big-endian. A base of SYNC_NO_BASE means
+//					the rows are measured against an empty board.
+//
+//***************************************************************************************
+
+#pragma once
+
+#include <string>
+#include "trisengine.h"
+using std::string;
+
+#define SYNC_NO_BASE		0xFFFF		// Revision of the empty board image
+#define SYNC_HEADERSIZE		8			// Revision, base revision, row mask
+#define SYNC_ROWSIZE		3			// Occupancy mask preceding each row's runs
+
+//***************************************************************************************
+//
+//	Class:		cBoardImage
+//	Purpose:	Copy of a board as last sent to one client, tagged with the board
+//				revision it was taken at. The client holds the matching copy.
+//
+//***************************************************************************************
+class cBoardImage
+{
+public:
+	cBoardImage() { clear(); }
+
+	void clear();								// Forgets image; empty board
+	void sync(string &out, cTrisEngine &board, int revision);	// Appends delta, keeps board
+	bool apply(cTrisEngine &board, const char* data, int length);	// Applies delta to image
+																	// and image to board
+
+	int revision() { return mRevision; }
+
+	static int nextRevision(int revision) { return (revision + 1) % SYNC_NO_BASE; }
+
+private:
+
+	bool differs(cTrisEngine &board, int y);	// Compares one row with board
+
+	unsigned int mRows[BOARD_ROW_STORAGE];		// Occupancy of each row
+	char mFaces[BOARD_ROW_STORAGE][BOARD_MAX_WIDTH];	// Unit appearance by row
+	int mRevision;								// Board revision of image
+};
+
+//***************************************************************************************
+//
+//	Function:	clear
+//	Purpose:	Resets image to an empty board with no revision
+//
+//***************************************************************************************
+inline void cBoardImage::clear()
+{
+	for(int y(0); y < BOARD_ROW_STORAGE; y++)
+	{
+		mRows[y] = 0;
+		for(int x(0); x < BOARD_MAX_WIDTH; x++)
+			mFaces[y][x] = EMPTY_FACE;
+	}
+
+	mRevision = SYNC_NO_BASE;
+}
+
+//***************************************************************************************
+//
+//	Function:	differs
+//	Purpose:	Compares a row of the image with the same row of a board
+//	Return:		True if occupancy or any unit's face differs
+//
+//***************************************************************************************
+inline bool cBoardImage::differs(cTrisEngine &board, int y)
+{
+	unsigned int row = board.row(y);
+	bool different = (row != mRows[y]);
+
+	for(int x(0); x < board.width() && !different; x++)
+		if(row & (1u << x))
+			different = (board.face(x, y) != mFaces[y][x]);
+
+	return different;
+}
+
+//***************************************************************************************
+//
+//	Function:	sync
+//	Purpose:	Appends a resync payload holding the rows of the board that differ
+//				from this image, then takes the board as the new image
+//
+//***************************************************************************************
+inline void cBoardImage::sync(string &out, cTrisEngine &board, int revision)
+{
+	unsigned int mask(0);
+	string rows;
+	int x, y, run;
+	char face(EMPTY_FACE);
+
+	for(y = 0; y < board.height(); y++)
+	{
+		if(!differs(board, y))
+			continue;
+
+		mask |= 1u << y;
+		mRows[y] = board.row(y);
+
+		rows += char(mRows[y] >> 16 & 0xFF);
+		rows += char(mRows[y] >> 8 & 0xFF);
+		rows += char(mRows[y] & 0xFF);
+
+		run = 0;
+		for(x = 0; x < board.width(); x++)
+		{
+			mFaces[y][x] = board.face(x, y);
+
+			if(!(mRows[y] & (1u << x)))
+				continue;
+
+			if(run > 0 && mFaces[y][x] != face)		// Face changes; close run
+			{
+				rows += char(run);
+				rows += face;
+				run = 0;
+			}
+
+			face = mFaces[y][x];
+			run++;
+		}
+
+		if(run > 0)
+		{
+			rows += char(run);
+			rows += face;
+		}
+	}
+
+	out += char(revision >> 8 & 0xFF);
+	out += char(revision & 0xFF);
+	out += char(mRevision >> 8 & 0xFF);
+	out += char(mRevision & 0xFF);
+	out += char(mask >> 24 & 0xFF);
+	out += char(mask >> 16 & 0xFF);
+	out += char(mask >> 8 & 0xFF);
+	out += char(mask & 0xFF);
+	out += rows;
+
+	mRevision = revision;
+}
+
+//***************************************************************************************
+//
+//	Function:	apply
+//	Purpose:	Applies a resync payload to this image, then writes the image's
+//				rows over the board's. The payload must be based on the revision
+//				the image holds, or on the empty board. Rows the board changed
+//				since the image was taken are put back as well, so a board that
+//				has diverged is restored by a delta alone.
+//	Return:		True if payload is malformed or based on another revision; image
+//				and board are unchanged
+//
+//***************************************************************************************
+inline bool cBoardImage::apply(cTrisEngine &board, const char* data, int length)
+{
+	const unsigned char* bytes = (const unsigned char*)data;
+	unsigned int mask;
+	unsigned int row;
+	int newRevision, base;
+	int n, x, y, count;
+
+	if(length < SYNC_HEADERSIZE)
+		return true;
+
+	newRevision = bytes[0] << 8 | bytes[1];
+	base = bytes[2] << 8 | bytes[3];
+	mask = (unsigned int)bytes[4] << 24 | bytes[5] << 16 | bytes[6] << 8 | bytes[7];
+
+	if(base != SYNC_NO_BASE && base != mRevision)
+		return true;
+
+	if(board.height() < 32 && (mask >> board.height()) != 0)
+		return true;
+
+	// Check the whole payload before touching the image
+	n = SYNC_HEADERSIZE;
+	for(y = 0; y < board.height(); y++)
+	{
+		if(!(mask & (1u << y)))
+			continue;
+
+		if(n + SYNC_ROWSIZE > length)
+			return true;
+
+		row = bytes[n] << 16 | bytes[n + 1] << 8 | bytes[n + 2];
+		n += SYNC_ROWSIZE;
+
+		if(row >> board.width())
+			return true;
+
+		for(count = 0; row; row &= row - 1)	// Occupied units in row
+			count++;
+
+		while(count > 0)
+		{
+			if(n + 2 > length || bytes[n] == 0 || bytes[n] > count)
+				return true;
+
+			count -= bytes[n];
+			n += 2;
+		}
+	}
+
+	if(n != length)
+		return true;
+
+	if(base == SYNC_NO_BASE)
+		clear();
+
+	n = SYNC_HEADERSIZE;
+	for(y = 0; y < board.height(); y++)
+	{
+		if(mask & (1u << y))
+		{
+			mRows[y] = bytes[n] << 16 | bytes[n + 1] << 8 | bytes[n + 2];
+			n += SYNC_ROWSIZE;
+			count = 0;
+
+			for(x = 0; x < board.width(); x++)
+			{
+				mFaces[y][x] = EMPTY_FACE;
+
+				if(mRows[y] & (1u << x))
+				{
+					if(count == 0)					// Start next run
+					{
+						count = bytes[n];
+						n += 2;
+					}
+
+					mFaces[y][x] = (signed char)bytes[n - 1];
+					count--;
+				}
+			}
+		}
+
+		if(differs(board, y))
+			for(x = 0; x < board.width(); x++)
+			{
+				if(mRows[y] & (1u << x))
+					board.add(x, y, mFaces[y][x]);
+				else
+					board.erase(x, y);
+			}
+	}
+
+	mRevision = newRevision;
+
+	return false;
+}
@@ -0,0 +1,760 @@
+//***************************************************************************************
+//
+//	Date Created:	October 17, 2026
+//	File:			bot.h
+//	Project:		Blue Tetris
+//
+//	Purpose:		Computer player. A bot chooses where to lock each tetrad by
+//					scoring the boards that result from every reachable placement of
+//					the active tetrad and the tetrads queued after it, then feeds the
+//					input events that reach its choice to the board at a human pace.
+//
+//***************************************************************************************
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include "resource.h"
+#include "trisengine.h"
+#include "movegen.h"
+using std::vector;
+using std::string;
+
+#define BOT_LOOKAHEAD		2			// Tetrads searched: active and next
+#define BOT_MAXDEPTH		4			// Deepest supported lookahead
+#define BOT_INPUTDELAY		60			// Milliseconds between inputs
+#define BOT_THINKDELAY		250			// Milliseconds before moving a new tetrad
+#define BOT_TOPOUT			-1e9		// Score of a board that has topped out
+
+#define BOT_EASY			0			// Difficulties: active tetrad only
+#define BOT_NORMAL			1			// Active and next tetrads, every placement
+#define BOT_HARD			2			// Beam search through the preview queue
+
+#define BOT_BEAMWIDTH		32			// Boards kept per depth by BOT_HARD
+#define BOT_BEAMDEPTH		5			// Tetrads searched by BOT_HARD, preview allowing
+#define BOT_MAXBEAMDEPTH	8			// Active tetrad and the whole preview
+#define BOT_TABLEBITS		15			// Transposition table holds 2^bits boards
+
+//***************************************************************************************
+//
+//	Class:		cBotWeights
+//	Purpose:	Weights of the board features a bot scores. Defaults are the
+//				widely used tuning for (height, lines, holes, bumpiness).
+//
+//***************************************************************************************
+class cBotWeights
+{
+public:
+	cBotWeights(): mHeight(-0.510066), mLines(0.760666), mHoles(-0.35663),
+		mBumpiness(-0.184483) {}
+	cBotWeights(double height, double lines, double holes, double bumpiness):
+		mHeight(height), mLines(lines), mHoles(holes), mBumpiness(bumpiness) {}
+
+	double mHeight;						// Sum of column heights
+	double mLines;						// Lines cleared on the way
+	double mHoles;						// Empty locations below a unit
+	double mBumpiness;					// Sum of height steps between neighbours
+};
+
+//***************************************************************************************
+//
+//	Class:		cBeamSearch
+//	Purpose:	Beam search through the preview queue. Each depth places the next
+//				queued tetrad on every board kept from the depth before and keeps
+//				the best scoring boards. Boards are bare row occupancy, hashed by
+//				Zobrist keys (one per location, updated per unit placed), and a
+//				fixed-size transposition table drops boards already reached at
+//				the same depth by placing the same tetrads in another order.
+//
+//***************************************************************************************
+class cBeamSearch
+{
+public:
+	cBeamSearch();
+
+	int search(cTrisEngine &board, vector<cPlacement> &roots, cMoveGenerator &generator,
+		const cBotWeights &weights, int width, int depth);	// Index of best root
+
+	long long evaluated() { return mEvaluated; }	// Boards scored so far
+	long long transposed() { return mTransposed; }	// Boards dropped as repeats
+
+private:
+
+	// Board reached by the search
+	struct cNode
+	{
+		unsigned int mRows[BOARD_ROW_STORAGE];	// Occupancy of each row
+		unsigned long long mKey;				// Zobrist key of mRows
+		double mScore;							// Heuristic score
+		int mLines;								// Lines cleared on the way
+		int mRoot;								// Placement of the active tetrad it began with
+	};
+
+	// Transposition table entry
+	struct cEntry
+	{
+		unsigned long long mKey;				// Key of board and depth
+		unsigned int mStamp;					// Search that stored it
+	};
+
+	bool place(const cNode &parent, cPlacement &placement, cNode &child);
+	bool seen(unsigned long long key);			// Looks up and stores board
+	void prune(vector<cNode> &nodes, int width);	// Keeps best boards
+	unsigned long long hash(const unsigned int rows[]);
+	static bool better(const cNode &a, const cNode &b) { return a.mScore > b.mScore; }
+
+	unsigned long long mCells[BOARD_ROW_STORAGE][BOARD_MAX_WIDTH];	// Key per location
+	unsigned long long mDepths[BOT_MAXBEAMDEPTH];	// Key per depth
+	vector<cEntry> mTable;						// Allocated on first search
+	unsigned int mStamp;						// Current search
+
+	vector<cNode> mBeam;						// Boards kept at current depth
+	vector<cNode> mChildren;					// Boards reached from them
+	vector<cPlacement> mPlacements;
+	int mWidth;									// Metrics of board searched
+	int mHeight;
+	unsigned int mFullRow;
+
+	long long mEvaluated;
+	long long mTransposed;
+};
+
+//***************************************************************************************
+//
+//	Class:		cBot
+//	Purpose:	Plays one board. next() is polled with the current time and returns
+//				the input event due, if any; the owner applies it to the board and
+//				calls locked() when a tetrad locks. Search buffers are shared by all
+//				bots on a thread, so a bot itself is small.
+//
+//***************************************************************************************
+class cBot
+{
+public:
+	cBot(): mDepth(BOT_LOOKAHEAD), mBeamWidth(0), mBeamDepth(BOT_BEAMDEPTH) { reset(); }
+
+	void reset();								// Forgets game in progress
+	int next(cTrisEngine &board, long long now);	// Input event due now, or 0
+	void locked(cTrisEngine &board, long long now);	// Active tetrad has locked
+
+	bool plan(cTrisEngine &board);				// Chooses placement and path
+	double search(cTrisEngine &board, int depth, int lines);	// Best score reachable
+	static double evaluate(cTrisEngine &board, int lines, const cBotWeights &weights);
+	static double evaluate(const unsigned int rows[], int width, int height, int lines,
+		const cBotWeights &weights);
+
+	void setWeights(const cBotWeights &weights) { mWeights = weights; }
+	void setDepth(int depth) { mDepth = (depth < 1) ? 1 : (depth > BOT_MAXDEPTH) ? BOT_MAXDEPTH : depth; }
+	void setBeam(int width, int depth);			// Width 0 searches every placement
+	void setDifficulty(int difficulty);			// BOT_EASY to BOT_HARD
+	const cBotWeights& weights() { return mWeights; }
+	const cPlacement& target() { return mTarget; }	// Placement chosen by plan()
+
+private:
+
+	bool retarget(cTrisEngine &board);			// Finds path to chosen placement again
+	void setPath(const cPlacement &placement);	// Reads path from last top level search
+	static bool same(cPlacement &a, cPlacement &b);	// Compares units covered
+	static long long dropInterval(cTrisEngine &board)	// Never zero at high levels
+		{ long interval = BTDropInterval(board.level()); return interval > 0 ? interval : 1; }
+
+	// Search state shared by every bot on the calling thread
+	struct cSearch
+	{
+		cMoveGenerator mGenerator;
+		vector<cPlacement> mPlacements[BOT_MAXDEPTH];	// One list per depth
+		cBeamSearch mBeam;
+	};
+	static cSearch& shared() { static thread_local cSearch search; return search; }
+
+	cBotWeights mWeights;
+	int mDepth;									// Tetrads searched per decision
+	int mBeamWidth;								// Boards kept per depth; 0 for no beam
+	int mBeamDepth;								// Tetrads searched by beam
+
+	cPlacement mTarget;							// Chosen placement
+	bool mTargeted;								// Flags valid mTarget
+	bool mStale;								// Flags path needing a new search
+	string mPath;								// Input events to target
+	unsigned int mStep;							// Next event in mPath
+
+	bool mStarted;								// Flags timers set for this game
+	long long mNextInput;						// Time next input is allowed
+	long long mNextDrop;						// Time of next gravity drop
+};
+
+//***************************************************************************************
+//
+//	Function:	reset
+//	Purpose:	Forgets game in progress; timers start on the next poll
+//
+//***************************************************************************************
+inline void cBot::reset()
+{
+	mTargeted = false;
+	mStale = true;
+	mPath.clear();
+	mStep = 0;
+	mStarted = false;
+	mNextInput = 0;
+	mNextDrop = 0;
+}
+
+//***************************************************************************************
+//
+//	Function:	next
+//	Purpose:	Returns the input event due at the given time. Gravity is applied
+//				at the board's drop interval; otherwise inputs follow the planned
+//				path one per BOT_INPUTDELAY. A search is run when the path is stale.
+//	Return:		Input event (I_*); 0 if none is due
+//
+//***************************************************************************************
+inline int cBot::next(cTrisEngine &board, long long now)
+{
+	if(board.gameOver() || !board.getTetradPtr())
+		return 0;
+
+	if(!mStarted)
+	{
+		mStarted = true;
+		mNextInput = now + BOT_THINKDELAY;
+		mNextDrop = now + dropInterval(board);
+	}
+
+	if(now >= mNextDrop)
+	{
+		mNextDrop = now + dropInterval(board);
+		mStale = true;							// Path starts one row higher
+		return I_GRAVITY;
+	}
+
+	if(now < mNextInput)
+		return 0;
+
+	if(mStale)
+	{
+		if(!mTargeted || retarget(board))
+			plan(board);
+		mStale = false;
+	}
+
+	if(mStep >= mPath.length())
+		return 0;
+
+	mNextInput = now + BOT_INPUTDELAY;
+	return mPath[mStep++];
+}
+
+//***************************************************************************************
+//
+//	Function:	setBeam
+//	Purpose:	Sets beam width and the tetrads it searches, the active one
+//				included. Width 0 returns to searching every placement to the
+//				lookahead depth.
+//
+//***************************************************************************************
+inline void cBot::setBeam(int width, int depth)
+{
+	mBeamWidth = (width < 0) ? 0 : width;
+	mBeamDepth = (depth < 1) ? 1 : (depth > BOT_MAXBEAMDEPTH) ? BOT_MAXBEAMDEPTH : depth;
+}
+
+//***************************************************************************************
+//
+//	Function:	setDifficulty
+//	Purpose:	Chooses search by difficulty
+//
+//***************************************************************************************
+inline void cBot::setDifficulty(int difficulty)
+{
+	switch(difficulty)
+	{
+	case BOT_EASY:
+		setDepth(1);
+		setBeam(0, BOT_BEAMDEPTH);
+		break;
+
+	case BOT_HARD:
+		setBeam(BOT_BEAMWIDTH, BOT_BEAMDEPTH);
+		break;
+
+	default:
+		setDepth(BOT_LOOKAHEAD);
+		setBeam(0, BOT_BEAMDEPTH);
+		break;
+	};
+}
+
+//***************************************************************************************
+//
+//	Function:	locked
+//	Purpose:	Starts thinking about the tetrad that replaced the one locked
+//
+//***************************************************************************************
+inline void cBot::locked(cTrisEngine &board, long long now)
+{
+	mTargeted = false;
+	mStale = true;
+	mPath.clear();
+	mStep = 0;
+	mNextInput = now + BOT_THINKDELAY;
+	mNextDrop = now + dropInterval(board);
+}
+
+//***************************************************************************************
+//
+//	Function:	plan
+//	Purpose:	Searches placements of the active tetrad, scoring each by the best
+//				board reachable with the tetrads after it, and sets the path to
+//				the best. With a beam set, only the best boards of each depth are
+//				searched further.
+//	Return:		True if active tetrad has no placement
+//
+//***************************************************************************************
+inline bool cBot::plan(cTrisEngine &board)
+{
+	cSearch &state = shared();
+	vector<cPlacement> &placements = state.mPlacements[0];
+	double best(0);
+	double score;
+	int chosen(-1);
+	int cleared;
+
+	mTargeted = false;
+	mPath.clear();
+	mStep = 0;
+
+	state.mGenerator.generate(board, placements);
+
+	if(mBeamWidth > 0)
+	{
+		chosen = state.mBeam.search(board, placements, state.mGenerator, mWeights,
+			mBeamWidth, mBeamDepth);
+		if(chosen < 0 && !placements.empty())	// Topping out whatever happens
+			chosen = 0;
+	}
+
+	for(unsigned int i(0); i < placements.size() && mBeamWidth == 0; i++)
+	{
+		cTrisEngine after(board);
+
+		cMoveGenerator::lock(after, placements[i], cleared);
+
+		if(after.gameOver())
+			score = BOT_TOPOUT;
+		else if(mDepth > 1)
+			score = search(after, 1, cleared);
+		else
+			score = evaluate(after, cleared, mWeights);
+
+		if(chosen < 0 || score > best)
+		{
+			best = score;
+			chosen = (int)i;
+		}
+	}
+
+	if(chosen < 0)
+		return true;
+
+	mTarget = placements[chosen];
+	mTargeted = true;
+
+	state.mGenerator.generate(board, placements);	// Deeper searches replaced the paths
+	setPath(mTarget);
+
+	return false;
+}
+
+//***************************************************************************************
+//
+//	Function:	search
+//	Purpose:	Scores the best board reachable by placing the board's active
+//				tetrad and those after it, down to the bot's depth. Tetrads come
+//				from the board's own queue, as play would draw them.
+//	Return:		Best score; BOT_TOPOUT if every placement tops out
+//
+//***************************************************************************************
+inline double cBot::search(cTrisEngine &board, int depth, int lines)
+{
+	cSearch &state = shared();
+	vector<cPlacement> &placements = state.mPlacements[depth];
+	double best(BOT_TOPOUT);
+	double score;
+	int cleared;
+
+	state.mGenerator.generate(board, placements);
+
+	for(unsigned int i(0); i < placements.size(); i++)
+	{
+		cTrisEngine after(board);
+
+		cMoveGenerator::lock(after, placements[i], cleared);
+
+		if(after.gameOver())
+			continue;
+		else if(depth + 1 < mDepth && depth + 1 < BOT_MAXDEPTH)
+			score = search(after, depth + 1, lines + cleared);
+		else
+			score = evaluate(after, lines + cleared, mWeights);
+
+		if(score > best)
+			best = score;
+	}
+
+	return best;
+}
+
+//***************************************************************************************
+//
+//	Function:	evaluate
+//	Purpose:	Scores a board by weighted features, computed a row at a time from
+//				the top: a column's height is set by its highest unit, and an empty
+//				location under any unit is a hole.
+//	Return:		Score; higher is better
+//
+//***************************************************************************************
+inline double cBot::evaluate(cTrisEngine &board, int lines, const cBotWeights &weights)
+{
+	unsigned int rows[BOARD_ROW_STORAGE];
+
+	for(int y(0); y < board.height(); y++)
+		rows[y] = board.row(y);
+
+	return evaluate(rows, board.width(), board.height(), lines, weights);
+}
+
+inline double cBot::evaluate(const unsigned int rows[], int width, int height, int lines,
+	const cBotWeights &weights)
+{
+	int heights[BOARD_MAX_WIDTH];
+	unsigned int covered(0);					// Columns with a unit above
+	unsigned int row, fresh;
+	int aggregate(0);
+	int holes(0);
+	int bumpiness(0);
+	int x;
+
+	for(x = 0; x < width; x++)
+		heights[x] = 0;
+
+	for(int y(height - 1); y >= 0; y--)
+	{
+		row = rows[y];
+		fresh = row & ~covered;
+
+		for(x = 0; fresh; x++, fresh >>= 1)
+			if(fresh & 1)
+				heights[x] = y + 1;
+
+		for(unsigned int gaps(covered & ~row); gaps; gaps &= gaps - 1)
+			holes++;
+
+		covered |= row;
+	}
+
+	for(x = 0; x < width; x++)
+	{
+		aggregate += heights[x];
+		if(x + 1 < width)
+			bumpiness += abs(heights[x] - heights[x + 1]);
+	}
+
+	return weights.mHeight * aggregate + weights.mLines * lines +
+		weights.mHoles * holes + weights.mBumpiness * bumpiness;
+}
+
+//***************************************************************************************
+//
+//	Function:	retarget
+//	Purpose:	Finds a path from the tetrad's current position to the placement
+//				already chosen, after gravity has moved it
+//	Return:		True if the placement can no longer be reached
+//
+//***************************************************************************************
+inline bool cBot::retarget(cTrisEngine &board)
+{
+	cSearch &state = shared();
+	vector<cPlacement> &placements = state.mPlacements[0];
+
+	state.mGenerator.generate(board, placements);
+
+	for(unsigned int i(0); i < placements.size(); i++)
+	{
+		if(same(placements[i], mTarget))
+		{
+			setPath(placements[i]);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//***************************************************************************************
+//
+//	Function:	setPath
+//	Purpose:	Reads the path to a placement from the last top level search. The
+//				straight drop that ends it becomes a sonic lock.
+//
+//***************************************************************************************
+inline void cBot::setPath(const cPlacement &placement)
+{
+	shared().mGenerator.path(placement, mPath);
+
+	while(!mPath.empty() && mPath[mPath.length() - 1] == char(I_DOWN))
+		mPath.erase(mPath.length() - 1);
+
+	mPath += char(I_SONIC_LOCK);
+	mStep = 0;
+}
+
+//***************************************************************************************
+//
+//	Function:	same
+//	Purpose:	Compares the units covered by two placements
+//	Return:		True if both cover the same locations
+//
+//***************************************************************************************
+inline bool cBot::same(cPlacement &a, cPlacement &b)
+{
+	int matched(0);
+
+	if(a.mType != b.mType)
+		return false;
+
+	for(int i(0); i < 4; i++)
+		for(int j(0); j < 4; j++)
+			if(a.x(i) == b.x(j) && a.y(i) == b.y(j))
+				matched++;
+
+	return matched == 4;
+}
+
+//-------------------------------------------------------------------------------------O
+//
+//	cBeamSearch
+//
+
+//***************************************************************************************
+//
+//	Function:	constructor
+//	Purpose:	Draws Zobrist keys from a fixed seed
+//
+//***************************************************************************************
+inline cBeamSearch::cBeamSearch(): mStamp(0), mWidth(0), mHeight(0), mFullRow(0),
+mEvaluated(0), mTransposed(0)
+{
+	cRandom random;
+	int x, y;
+
+	for(y = 0; y < BOARD_ROW_STORAGE; y++)
+		for(x = 0; x < BOARD_MAX_WIDTH; x++)
+			mCells[y][x] = (unsigned long long)random.next() << 32 | random.next();
+
+	for(y = 0; y < BOT_MAXBEAMDEPTH; y++)
+		mDepths[y] = (unsigned long long)random.next() << 32 | random.next();
+}
+
+//***************************************************************************************
+//
+//	Function:	search
+//	Purpose:	Searches from the placements of the board's active tetrad through
+//				as much of the preview queue as depth allows, keeping width boards
+//				per depth. Roots must come from the generator's last search.
+//	Return:		Index into roots of best first placement; -1 if all top out
+//
+//***************************************************************************************
+inline int cBeamSearch::search(cTrisEngine &board, vector<cPlacement> &roots,
+	cMoveGenerator &generator, const cBotWeights &weights, int width, int depth)
+{
+	int types[BOT_MAXBEAMDEPTH];
+	int levels(1);
+	int best(-1);
+	unsigned int i, j;
+	cNode root;
+	cNode child;
+
+	if(mTable.empty())
+		mTable.resize((size_t)1 << BOT_TABLEBITS);
+
+	if(++mStamp == 0)							// Stamps wrapped: forget old entries
+	{
+		for(i = 0; i < mTable.size(); i++)
+			mTable[i].mStamp = 0;
+		mStamp = 1;
+	}
+
+	mWidth = board.width();
+	mHeight = board.height();
+	mFullRow = (1u << mWidth) - 1;
+
+	for(int y(0); y < mHeight; y++)
+		root.mRows[y] = board.row(y);
+	root.mKey = hash(root.mRows);
+	root.mLines = 0;
+	root.mRoot = -1;
+
+	while(levels < depth && levels < BOT_MAXBEAMDEPTH && board.preview(levels - 1) >= 0)
+	{
+		types[levels] = board.preview(levels - 1);
+		levels++;
+	}
+
+	mBeam.clear();
+	for(i = 0; i < roots.size(); i++)
+	{
+		if(place(root, roots[i], child) || seen(child.mKey ^ mDepths[0]))
+			continue;
+
+		child.mRoot = (int)i;
+		child.mScore = cBot::evaluate(child.mRows, mWidth, mHeight, child.mLines, weights);
+		mEvaluated++;
+		mBeam.push_back(child);
+	}
+	prune(mBeam, width);
+
+	for(int d(1); d < levels && !mBeam.empty(); d++)
+	{
+		mChildren.clear();
+
+		for(i = 0; i < mBeam.size(); i++)
+		{
+			generator.generate(mBeam[i].mRows, mWidth, mHeight, types[d], mPlacements);
+
+			for(j = 0; j < mPlacements.size(); j++)
+			{
+				if(place(mBeam[i], mPlacements[j], child) || seen(child.mKey ^ mDepths[d]))
+					continue;
+
+				child.mRoot = mBeam[i].mRoot;
+				child.mScore = cBot::evaluate(child.mRows, mWidth, mHeight, child.mLines, weights);
+				mEvaluated++;
+				mChildren.push_back(child);
+			}
+		}
+
+		if(mChildren.empty())					// Every line tops out: judge by depth before
+			break;
+
+		prune(mChildren, width);
+		mBeam.swap(mChildren);
+	}
+
+	for(i = 0; i < mBeam.size(); i++)
+		if(best < 0 || mBeam[i].mScore > mBeam[best].mScore)
+			best = (int)i;
+
+	return best < 0 ? -1 : mBeam[best].mRoot;
+}
+
+//***************************************************************************************
+//
+//	Function:	place
+//	Purpose:	Locks a placement on a copy of parent's board, clearing full lines
+//				as the engine would. The key follows the units added; a line
+//				clear moves every row, so the key is then computed again.
+//	Return:		True if the board tops out
+//
+//***************************************************************************************
+inline bool cBeamSearch::place(const cNode &parent, cPlacement &placement, cNode &child)
+{
+	int lines(0);
+	int target(0);
+	int x, y;
+
+	memcpy(child.mRows, parent.mRows, mHeight * sizeof(unsigned int));
+	child.mKey = parent.mKey;
+
+	for(int i(0); i < 4; i++)
+	{
+		x = placement.x(i);
+		y = placement.y(i);
+		child.mRows[y] |= 1u << x;
+		child.mKey ^= mCells[y][x];
+	}
+
+	for(y = 0; y < mHeight; y++)
+	{
+		if(child.mRows[y] == mFullRow)
+			lines++;
+		else
+			child.mRows[target++] = child.mRows[y];
+	}
+
+	if(lines)
+	{
+		for(; target < mHeight; target++)
+			child.mRows[target] = 0;
+		child.mKey = hash(child.mRows);
+	}
+
+	child.mLines = parent.mLines + lines;
+
+	return (child.mRows[mHeight - 1] | child.mRows[mHeight - 2]) != 0;
+}
+
+//***************************************************************************************
+//
+//	Function:	seen
+//	Purpose:	Looks up a board and depth key in the transposition table, storing
+//				it if absent. A slot holds the last key stored there.
+//	Return:		True if key was already stored this search
+//
+//***************************************************************************************
+inline bool cBeamSearch::seen(unsigned long long key)
+{
+	cEntry &entry = mTable[key & (mTable.size() - 1)];
+
+	if(entry.mStamp == mStamp && entry.mKey == key)
+	{
+		mTransposed++;
+		return true;
+	}
+
+	entry.mKey = key;
+	entry.mStamp = mStamp;
+	return false;
+}
+
+//***************************************************************************************
+//
+//	Function:	prune
+//	Purpose:	Keeps the width best scoring boards, in no particular order
+//
+//***************************************************************************************
+inline void cBeamSearch::prune(vector<cNode> &nodes, int width)
+{
+	if((int)nodes.size() <= width)
+		return;
+
+	std::nth_element(nodes.begin(), nodes.begin() + width, nodes.end(), better);
+	nodes.resize(width);
+}
+
+//***************************************************************************************
+//
+//	Function:	hash
+//	Purpose:	Computes Zobrist key of a board from scratch
+//	Return:		XOR of the keys of occupied locations
+//
+//***************************************************************************************
+inline unsigned long long cBeamSearch::hash(const unsigned int rows[])
+{
+	unsigned long long key(0);
+	unsigned int bits;
+
+	int x;
+
+	for(int y(0); y < mHeight; y++)
+		for(bits = rows[y], x = 0; bits; bits >>= 1, x++)
+			if(bits & 1)
+				key ^= mCells[y][x];
+
+	return key;
+}
@@ -0,0 +1,154 @@
+//***************************************************************************************
+//
+//	Date Created:	October 17, 2026
+//	File:			frame.h
+//	Project:		Blue Tetris
+//
+//	Purpose:		Wire format shared by the Blue Tetris client and server. Every
+//					message travels as a frame: a fixed header giving the protocol
+//					version, state, message code, client ID and payload length,
+//					followed by the payload bytes. Payloads may hold any byte value.
+//
+//					Inside the programs a message is still a string of header byte,
+//					message byte and payload; cFrame converts between the two.
+//
+//***************************************************************************************
+
+#pragma once
+
+#include <string>
+#include "resource.h"
+using std::string;
+
+#define FRAME_VERSION		1			// Protocol version; first byte of every frame
+#define FRAME_HEADERSIZE	6			// Version, state, code, client, length (2 bytes)
+#define FRAME_MAXPAYLOAD	4096		// Largest payload accepted
+
+#define FRAME_INCOMPLETE	0			// parse(): more bytes are needed
+#define FRAME_MALFORMED		-1			// parse(): stream cannot be a frame
+
+//***************************************************************************************
+//
+//	Class:		cFrame
+//	Purpose:	View of one frame. After parse() the payload points into the
+//				caller's buffer, so nothing is copied until the caller asks for it.
+//
+//***************************************************************************************
+class cFrame
+{
+public:
+	cFrame(): mState(0), mCode(0), mClient(0), mPayload(NULL), mLength(0) {}
+
+	int parse(const char* data, int length);	// Reads frame at start of buffer
+	string message() const;						// Message string for this frame
+	string message(int client) const;			// Same, with client ID replaced
+
+	static void encode(string &out, int state, int code, int client,
+		const char* payload, int length);		// Appends frame to buffer
+	static bool encode(string &out, const string &message);	// Appends message as frame
+
+	int mState;									// Game state the message belongs to
+	int mCode;									// Message code (M_*)
+	int mClient;								// Client ID, or C_GLOBAL
+	const char* mPayload;						// Payload bytes; not null terminated
+	int mLength;								// Payload length
+};
+
+//***************************************************************************************
+//
+//	Function:	parse
+//	Purpose:	Reads the frame at the start of the buffer without copying it
+//	Return:		Frame size in bytes, FRAME_INCOMPLETE if the buffer holds only part
+//				of a frame, or FRAME_MALFORMED if the version or length is invalid
+//
+//***************************************************************************************
+inline int cFrame::parse(const char* data, int length)
+{
+	const unsigned char* bytes = (const unsigned char*)data;
+
+	if(length < 1)
+		return FRAME_INCOMPLETE;
+
+	if(bytes[0] != FRAME_VERSION)
+		return FRAME_MALFORMED;
+
+	if(length < FRAME_HEADERSIZE)
+		return FRAME_INCOMPLETE;
+
+	mState = bytes[1];
+	mCode = bytes[2];
+	mClient = bytes[3];
+	mLength = bytes[4] << 8 | bytes[5];
+	mPayload = data + FRAME_HEADERSIZE;
+
+	if(mState > 3 || mClient > 7 || mLength > FRAME_MAXPAYLOAD)
+		return FRAME_MALFORMED;
+
+	if(length < FRAME_HEADERSIZE + mLength)
+		return FRAME_INCOMPLETE;
+
+	return FRAME_HEADERSIZE + mLength;
+}
+
+//***************************************************************************************
+//
+//	Function:	message
+//	Purpose:	Copies frame into a message string: header byte, message byte
+//				and payload
+//	Return:		Message string
+//
+//***************************************************************************************
+inline string cFrame::message() const
+{
+	return message(mClient);
+}
+
+inline string cFrame::message(int client) const
+{
+	string result;
+
+	result.reserve(2 + mLength);
+	result += char(client + mState * 8 + BT_CODE * 32);
+	result += char(mCode);
+	result.append(mPayload, mLength);
+
+	return result;
+}
+
+//***************************************************************************************
+//
+//	Function:	encode
+//	Purpose:	Appends a frame to an output buffer
+//
+//***************************************************************************************
+inline void cFrame::encode(string &out, int state, int code, int client,
+	const char* payload, int length)
+{
+	out += char(FRAME_VERSION);
+	out += char(state);
+	out += char(code);
+	out += char(client);
+	out += char(length >> 8 & 0xFF);
+	out += char(length & 0xFF);
+	out.append(payload, length);
+}
+
+//***************************************************************************************
+//
+//	Function:	encode (message string)
+//	Purpose:	Appends a message string to an output buffer as a frame
+//	Return:		True if message is too short or too long to send
+//
+//***************************************************************************************
+inline bool cFrame::encode(string &out, const string &message)
+{
+	int length = (int)message.length() - 2;
+
+	if(length < 0 || length > FRAME_MAXPAYLOAD)
+		return true;
+
+	encode(out, message[0] >> 3 & 3, (unsigned char)message[1], message[0] & 7,
+		message.data() + 2, length);
+
+	return false;
+}
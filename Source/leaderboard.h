@@ -0,0 +1,448 @@
+//***************************************************************************************
+//
+//	Date Created:	October 17, 2026
+//	File:			leaderboard.h
+//	Project:		Blue Tetris
+//
+//	Purpose:		Unbounded high score leaderboard. Entries are kept in an indexable
+//					skip list ordered best first: each link records how many entries
+//					it passes over, so inserting, finding a player's rank and reading
+//					the entry at a rank all take O(log n). A player holds one entry,
+//					their best score; equal scores rank in the order they were reached.
+//
+//***************************************************************************************
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include "random.h"
+
+using std::string;
+using std::unordered_map;
+
+#define LEADERBOARD_MAXLEVEL	24		// Link levels; ample for 4^24 entries
+#define LEADERBOARD_NORANK		0		// rank(): player has no entry
+
+//***************************************************************************************
+//
+//	Class:		cScoreRecord
+//	Purpose:	One stored score: player, score and the board settings played on
+//
+//***************************************************************************************
+class cScoreRecord
+{
+public:
+	cScoreRecord(): mScore(0), mWidth(0), mHeight(0), mLevel(0) {}
+	cScoreRecord(const string &name, long double score, int width, int height, int level):
+		mName(name), mScore(score), mWidth(width), mHeight(height), mLevel(level) {}
+
+	string mName;
+	long double mScore;
+	int mWidth;									// Board columns
+	int mHeight;								// Board rows
+	int mLevel;									// Starting level
+};
+
+//***************************************************************************************
+//
+//	Class:		cLeaderboard
+//	Purpose:	Ranked list of players' best scores. Ranks count from 1.
+//
+//***************************************************************************************
+class cLeaderboard
+{
+public:
+	cLeaderboard();
+	~cLeaderboard() { clear(); }
+
+	long long submit(const string &name, long double score);	// Enters score
+	long long rank(const string &name);			// Rank of player's entry
+	int page(long long first, int count, string names[], long double scores[]);
+	long long around(const string &name, int count, string names[], long double scores[],
+		int &found);							// Page holding player's entry
+	long double score(long long rank);			// Score at rank; 0 past the end
+
+	long long size() { return mSize; }
+	void clear();
+
+private:
+
+	cLeaderboard(const cLeaderboard&);			// Not copyable
+	cLeaderboard& operator=(const cLeaderboard&);
+
+	struct cNode;
+
+	struct cLink
+	{
+		cNode* mNext;
+		long long mSpan;						// Entries passed, counting mNext
+	};
+
+	struct cNode
+	{
+		const string* mName;					// Key of the player index
+		long double mScore;
+		unsigned long long mOrder;				// Breaks ties: earlier ranks higher
+		int mLevel;
+		cLink mLinks[1];						// mLevel links, lowest first, allocated
+	};											// with the node to share its cache lines
+
+	static bool before(const cNode* a, long double score, unsigned long long order)
+		{ return a->mScore > score || (a->mScore == score && a->mOrder < order); }
+
+	long long insert(cNode* node);				// Links node in by score
+	void unlink(cNode* node);					// Removes node from the list
+	long long position(const cNode* node);		// Rank of linked node
+	cNode* at(long long rank);					// Node at rank; NULL past the end
+	int drawLevel();							// Link levels of a new node
+	static cNode* create(int level);			// Allocates node with its links
+	static void destroy(cNode* node) { ::operator delete(node); }
+
+	cLink mHead[LEADERBOARD_MAXLEVEL];			// Links before the first entry
+	int mLevel;									// Levels in use
+	long long mSize;
+	unsigned long long mSequence;				// Order given to the next score
+	unordered_map<string, cNode*> mPlayers;		// Entry of each player
+	cRandom mRandom;							// Draws link levels
+};
+
+//***************************************************************************************
+//
+//	Function:	constructor
+//	Purpose:	Creates empty leaderboard
+//
+//***************************************************************************************
+inline cLeaderboard::cLeaderboard(): mLevel(1), mSize(0), mSequence(0)
+{
+	for(int i(0); i < LEADERBOARD_MAXLEVEL; i++)
+	{
+		mHead[i].mNext = NULL;
+		mHead[i].mSpan = 0;
+	}
+}
+
+//***************************************************************************************
+//
+//	Function:	submit
+//	Purpose:	Enters a player's score unless the player already holds one at
+//				least as high; an improved score moves the player's entry
+//	Return:		New rank of the player's entry; LEADERBOARD_NORANK if unchanged
+//
+//***************************************************************************************
+inline long long cLeaderboard::submit(const string &name, long double score)
+{
+	unordered_map<string, cNode*>::iterator player = mPlayers.find(name);
+	cNode* node;
+
+	if(player != mPlayers.end())
+	{
+		node = player->second;
+		if(score <= node->mScore)
+			return LEADERBOARD_NORANK;
+
+		unlink(node);
+	}
+	else
+	{
+		player = mPlayers.insert(std::make_pair(name, (cNode*)NULL)).first;
+
+		node = create(drawLevel());
+		node->mName = &player->first;
+		player->second = node;
+	}
+
+	node->mScore = score;
+	node->mOrder = mSequence++;
+
+	return insert(node);
+}
+
+//***************************************************************************************
+//
+//	Function:	rank
+//	Purpose:	Finds rank of a player's entry
+//	Return:		Rank; LEADERBOARD_NORANK if player has no entry
+//
+//***************************************************************************************
+inline long long cLeaderboard::rank(const string &name)
+{
+	unordered_map<string, cNode*>::iterator player = mPlayers.find(name);
+
+	if(player == mPlayers.end())
+		return LEADERBOARD_NORANK;
+
+	return position(player->second);
+}
+
+//***************************************************************************************
+//
+//	Function:	page
+//	Purpose:	Copies up to count entries starting at rank first
+//	Return:		Entries copied
+//
+//***************************************************************************************
+inline int cLeaderboard::page(long long first, int count, string names[], long double scores[])
+{
+	cNode* node = at(first);
+	int n(0);
+
+	for(; node && n < count; node = node->mLinks[0].mNext, n++)
+	{
+		names[n] = *node->mName;
+		scores[n] = node->mScore;
+	}
+
+	return n;
+}
+
+//***************************************************************************************
+//
+//	Function:	around
+//	Purpose:	Copies a page of up to count entries with the player's entry as
+//				near the middle as the ends of the list allow
+//	Return:		Rank of first entry copied; LEADERBOARD_NORANK if player has no
+//				entry. found receives the number of entries copied.
+//
+//***************************************************************************************
+inline long long cLeaderboard::around(const string &name, int count, string names[],
+	long double scores[], int &found)
+{
+	long long player = rank(name);
+	long long first;
+
+	found = 0;
+	if(player == LEADERBOARD_NORANK || count < 1)
+		return LEADERBOARD_NORANK;
+
+	first = player - count / 2;
+	if(first > mSize - count + 1)
+		first = mSize - count + 1;
+	if(first < 1)
+		first = 1;
+
+	found = page(first, count, names, scores);
+	return first;
+}
+
+//***************************************************************************************
+//
+//	Function:	score
+//	Purpose:	Reads score at a rank
+//	Return:		Score; 0 if rank is past the end of the list
+//
+//***************************************************************************************
+inline long double cLeaderboard::score(long long rank)
+{
+	cNode* node = at(rank);
+
+	return node ? node->mScore : 0;
+}
+
+//***************************************************************************************
+//
+//	Function:	clear
+//	Purpose:	Removes every entry
+//
+//***************************************************************************************
+inline void cLeaderboard::clear()
+{
+	cNode* node = mHead[0].mNext;
+
+	while(node)
+	{
+		cNode* next = node->mLinks[0].mNext;
+
+		destroy(node);
+		node = next;
+	}
+
+	for(int i(0); i < LEADERBOARD_MAXLEVEL; i++)
+	{
+		mHead[i].mNext = NULL;
+		mHead[i].mSpan = 0;
+	}
+
+	mPlayers.clear();
+	mLevel = 1;
+	mSize = 0;
+}
+
+//***************************************************************************************
+//
+//	Function:	insert
+//	Purpose:	Links node in after every entry that ranks above it. Spans of the
+//				links stepped over are adjusted on the way down.
+//	Return:		Rank of node
+//
+//***************************************************************************************
+inline long long cLeaderboard::insert(cNode* node)
+{
+	cLink* update[LEADERBOARD_MAXLEVEL];		// Last link before node, each level
+	long long passed[LEADERBOARD_MAXLEVEL];		// Rank reached at that link
+	cLink* links = mHead;
+	long long rank(0);
+	int i;
+
+	for(i = mLevel - 1; i >= 0; i--)
+	{
+		while(links[i].mNext && before(links[i].mNext, node->mScore, node->mOrder))
+		{
+			rank += links[i].mSpan;
+			links = links[i].mNext->mLinks;
+		}
+
+		update[i] = &links[i];
+		passed[i] = rank;
+	}
+
+	for(i = mLevel; i < node->mLevel; i++)		// New levels start at the head
+	{
+		update[i] = &mHead[i];
+		update[i]->mSpan = mSize;
+		passed[i] = 0;
+	}
+	if(node->mLevel > mLevel)
+		mLevel = node->mLevel;
+
+	for(i = 0; i < node->mLevel; i++)
+	{
+		node->mLinks[i].mNext = update[i]->mNext;
+		node->mLinks[i].mSpan = update[i]->mSpan - (rank - passed[i]);
+		update[i]->mNext = node;
+		update[i]->mSpan = rank - passed[i] + 1;
+	}
+
+	for(; i < mLevel; i++)						// Higher links now pass one more
+		update[i]->mSpan++;
+
+	mSize++;
+	return rank + 1;
+}
+
+//***************************************************************************************
+//
+//	Function:	unlink
+//	Purpose:	Removes node from the list, joining the links around it
+//
+//***************************************************************************************
+inline void cLeaderboard::unlink(cNode* node)
+{
+	cLink* links = mHead;
+	int i;
+
+	for(i = mLevel - 1; i >= 0; i--)
+	{
+		while(links[i].mNext && links[i].mNext != node &&
+			before(links[i].mNext, node->mScore, node->mOrder))
+			links = links[i].mNext->mLinks;
+
+		if(links[i].mNext == node)
+		{
+			links[i].mSpan += node->mLinks[i].mSpan - 1;
+			links[i].mNext = node->mLinks[i].mNext;
+		}
+		else
+			links[i].mSpan--;
+	}
+
+	while(mLevel > 1 && mHead[mLevel - 1].mNext == NULL)
+		mLevel--;
+
+	mSize--;
+}
+
+//***************************************************************************************
+//
+//	Function:	position
+//	Purpose:	Sums spans on the way to a linked node
+//	Return:		Rank of node
+//
+//***************************************************************************************
+inline long long cLeaderboard::position(const cNode* node)
+{
+	cLink* links = mHead;
+	long long rank(0);
+
+	for(int i(mLevel - 1); i >= 0; i--)
+	{
+		while(links[i].mNext && (links[i].mNext == node ||
+			before(links[i].mNext, node->mScore, node->mOrder)))
+		{
+			rank += links[i].mSpan;
+			if(links[i].mNext == node)
+				return rank;
+			links = links[i].mNext->mLinks;
+		}
+	}
+
+	return rank;
+}
+
+//***************************************************************************************
+//
+//	Function:	at
+//	Purpose:	Follows spans to a rank
+//	Return:		Node at rank; NULL if rank is out of range
+//
+//***************************************************************************************
+inline cLeaderboard::cNode* cLeaderboard::at(long long rank)
+{
+	cLink* links = mHead;
+	cNode* node = NULL;
+	long long passed(0);
+
+	if(rank < 1 || rank > mSize)
+		return NULL;
+
+	for(int i(mLevel - 1); i >= 0 && passed != rank; i--)
+	{
+		while(links[i].mNext && passed + links[i].mSpan <= rank)
+		{
+			passed += links[i].mSpan;
+			node = links[i].mNext;
+			links = node->mLinks;
+		}
+	}
+
+	return node;
+}
+
+//***************************************************************************************
+//
+//	Function:	create
+//	Purpose:	Allocates a node with room for the given number of links
+//	Return:		Node; only mLevel is set
+//
+//***************************************************************************************
+inline cLeaderboard::cNode* cLeaderboard::create(int level)
+{
+	cNode* node = (cNode*)::operator new(sizeof(cNode) + (level - 1) * sizeof(cLink));
+
+	node->mLevel = level;
+	return node;
+}
+
+//***************************************************************************************
+//
+//	Function:	drawLevel
+//	Purpose:	Draws link levels for a new node: each level above the first is
+//				kept with probability 1/4
+//	Return:		Level count
+//
+//***************************************************************************************
+inline int cLeaderboard::drawLevel()
+{
+	unsigned int bits = mRandom.next();
+	int level(1);
+
+	while(level < LEADERBOARD_MAXLEVEL && (bits & 3) == 0)
+	{
+		level++;
+		bits >>= 2;
+		if(level % 16 == 0)						// 32 bits give 16 draws
+			bits = mRandom.next();
+	}
+
+	return level;
+}
@@ -0,0 +1,316 @@
+//***************************************************************************************
+//
+//	Date Created:	October 17, 2026
+//	File:			movegen.cpp
+//	Project:		Blue Tetris
+//
+//	Purpose:		Function definitions for cMoveGenerator
+//
+//***************************************************************************************
+
+#include <string.h>
+#include <algorithm>
+#include "movegen.h"
+#include "resource.h"
+
+//***************************************************************************************
+//
+//	Function:	constructor
+//	Purpose:	Builds row masks for every tetrad orientation and finds orientations
+//				that cover the same units as another (O, and the halves of I, S, Z)
+//
+//***************************************************************************************
+cMoveGenerator::cMoveGenerator(): mWidth(0), mHeight(0), mType(0), mStamp(0),
+mHead(0), mTail(0), mStart(0), mNodes(0)
+{
+	memset(mSeen, 0, sizeof(mSeen));
+	memset(mPlaced, 0, sizeof(mPlaced));
+
+	for(int t(0); t < 7; t++)
+	{
+		for(int r(0); r < 4; r++)
+		{
+			cShape &shape = mShapes[t][r];
+			const int (*offsets)[2] = TETRAD_OFFSETS[t][r];
+
+			shape.mLeft = shape.mRight = offsets[0][0];
+			shape.mBottom = shape.mTop = offsets[0][1];
+
+			for(int i(1); i < 4; i++)
+			{
+				shape.mLeft = std::min(shape.mLeft, offsets[i][0]);
+				shape.mRight = std::max(shape.mRight, offsets[i][0]);
+				shape.mBottom = std::min(shape.mBottom, offsets[i][1]);
+				shape.mTop = std::max(shape.mTop, offsets[i][1]);
+			}
+
+			for(int k(0); k < 4; k++)
+				shape.mRows[k] = 0;
+
+			for(int i(0); i < 4; i++)
+				shape.mRows[offsets[i][1] - shape.mBottom] |= 1u << (offsets[i][0] - shape.mLeft);
+
+			shape.mCanonical = r;
+			for(int c(0); c < r && shape.mCanonical == r; c++)
+			{
+				cShape &other = mShapes[t][c];
+
+				if(other.mRight - other.mLeft == shape.mRight - shape.mLeft &&
+					other.mTop - other.mBottom == shape.mTop - shape.mBottom &&
+					!memcmp(other.mRows, shape.mRows, sizeof(shape.mRows)))
+					shape.mCanonical = c;
+			}
+		}
+	}
+}
+
+//***************************************************************************************
+//
+//	Function:	generate
+//	Purpose:	Lists placements reachable by the board's active tetrad
+//	Return:		Number of placements
+//
+//***************************************************************************************
+int cMoveGenerator::generate(cTrisEngine &board, vector<cPlacement> &out)
+{
+	cTetrad* tetrad = board.getTetradPtr();
+
+	if(!tetrad)
+	{
+		out.clear();
+		return 0;
+	}
+
+	return generate(board, *tetrad, out);
+}
+
+//***************************************************************************************
+//
+//	Function:	generate (type)
+//	Purpose:	Lists placements reachable by a tetrad of given type entering the
+//				board at its spawn position
+//	Return:		Number of placements
+//
+//***************************************************************************************
+int cMoveGenerator::generate(cTrisEngine &board, int type, vector<cPlacement> &out)
+{
+	return generate(board, cTetrad(type, board.width(), board.height()), out);
+}
+
+//***************************************************************************************
+//
+//	Function:	generate (tetrad)
+//	Purpose:	Lists placements reachable from given tetrad. A position is a
+//				placement when moving down from it collides; placements covering
+//				the same units are listed once.
+//	Return:		Number of placements
+//
+//***************************************************************************************
+int cMoveGenerator::generate(cTrisEngine &board, cTetrad tetrad, vector<cPlacement> &out)
+{
+	mWidth = board.width();
+	mHeight = board.height();
+
+	for(int y(0); y < mHeight; y++)
+		mRows[y] = board.row(y);
+
+	return search(tetrad, out);
+}
+
+//***************************************************************************************
+//
+//	Function:	generate (rows)
+//	Purpose:	Lists placements reachable by a tetrad of given type entering at
+//				its spawn position a board given only as row occupancy, as held
+//				by searches that do not keep a whole engine per position
+//	Return:		Number of placements
+//
+//***************************************************************************************
+int cMoveGenerator::generate(const unsigned int rows[], int width, int height, int type,
+	vector<cPlacement> &out)
+{
+	cTetrad tetrad(type, width, height);
+
+	mWidth = width;
+	mHeight = height;
+	memcpy(mRows, rows, height * sizeof(unsigned int));
+
+	return search(tetrad, out);
+}
+
+//***************************************************************************************
+//
+//	Function:	search
+//	Purpose:	Breadth-first search from tetrad over the board copied into mRows
+//	Return:		Number of placements
+//
+//***************************************************************************************
+int cMoveGenerator::search(cTetrad &tetrad, vector<cPlacement> &out)
+{
+	cPlacement placement;
+	int current, key;
+	int x, y, r;
+
+	out.clear();
+
+	mType = tetrad.type();
+
+	r = tetrad.rotation();
+	x = tetrad.x(0) - TETRAD_OFFSETS[mType][r][0][0];
+	y = tetrad.y(0) - TETRAD_OFFSETS[mType][r][0][1];
+
+	if(collides(x, y, r))						// Board is topped out
+		return 0;
+
+	nextStamp();
+	mHead = mTail = 0;
+	mStart = state(x, y, r);
+	visit(x, y, r, mStart, 0);
+
+	while(mHead < mTail)
+	{
+		current = mQueue[mHead++];
+		mNodes++;
+
+		r = current & 3;
+		x = (current >> 2) % MOVEGEN_XSPAN - MOVEGEN_XOFFSET;
+		y = (current >> 2) / MOVEGEN_XSPAN - MOVEGEN_YOFFSET;
+
+		visit(x - 1, y, r, current, I_LEFT);
+		visit(x + 1, y, r, current, I_RIGHT);
+		visit(x, y, (r + 3) & 3, current, I_ROTATE_LEFT);
+		visit(x, y, (r + 1) & 3, current, I_ROTATE_RIGHT);
+
+		if(!collides(x, y - 1, r))
+			visit(x, y - 1, r, current, I_DOWN);
+		else
+		{
+			const cShape &shape = mShapes[mType][r];
+			int canonical = shape.mCanonical;
+
+			key = state(x + shape.mLeft - mShapes[mType][canonical].mLeft,
+				y + shape.mBottom - mShapes[mType][canonical].mBottom, canonical);
+
+			if(mPlaced[key] != mStamp)
+			{
+				mPlaced[key] = mStamp;
+
+				placement.mType = mType;
+				placement.mRotation = r;
+				placement.mx = x;
+				placement.my = y;
+				placement.mState = current;
+				out.push_back(placement);
+			}
+		}
+	}
+
+	return (int)out.size();
+}
+
+//***************************************************************************************
+//
+//	Function:	collides
+//	Purpose:	Tests tetrad of the searched type at given origin and orientation
+//	Return:		True if any unit is off board or on an occupied location
+//
+//***************************************************************************************
+bool cMoveGenerator::collides(int x, int y, int r)
+{
+	const cShape &shape = mShapes[mType][r];
+	int left = x + shape.mLeft;
+	int bottom = y + shape.mBottom;
+
+	if(left < 0 || x + shape.mRight >= mWidth || bottom < 0 || y + shape.mTop >= mHeight)
+		return true;
+
+	for(int k(0); k <= shape.mTop - shape.mBottom; k++)
+		if((shape.mRows[k] << left) & mRows[bottom + k])
+			return true;
+
+	return false;
+}
+
+//***************************************************************************************
+//
+//	Function:	visit
+//	Purpose:	Queues a position not yet reached this search, if it is free
+//
+//***************************************************************************************
+void cMoveGenerator::visit(int x, int y, int r, int from, int move)
+{
+	if(x < -MOVEGEN_XOFFSET || x >= mWidth + MOVEGEN_XOFFSET ||
+		y < -MOVEGEN_YOFFSET || y >= mHeight + MOVEGEN_YOFFSET)
+		return;
+
+	int next = state(x, y, r);
+
+	if(mSeen[next] == mStamp || (move && collides(x, y, r)))
+		return;
+
+	mSeen[next] = mStamp;
+	mParent[next] = (short)from;
+	mMove[next] = (char)move;
+	mQueue[mTail++] = (short)next;
+}
+
+//***************************************************************************************
+//
+//	Function:	nextStamp
+//	Purpose:	Advances search stamp, clearing marks when it wraps
+//
+//***************************************************************************************
+void cMoveGenerator::nextStamp()
+{
+	if(++mStamp == 0)
+	{
+		memset(mSeen, 0, sizeof(mSeen));
+		memset(mPlaced, 0, sizeof(mPlaced));
+		mStamp = 1;
+	}
+}
+
+//***************************************************************************************
+//
+//	Function:	path
+//	Purpose:	Lists the input events (I_*) that take the tetrad from where the
+//				search began to the placement and lock it there. Only valid for
+//				placements from the most recent search.
+//
+//***************************************************************************************
+void cMoveGenerator::path(const cPlacement &placement, string &events)
+{
+	events.clear();
+
+	for(int s(placement.mState); s != mStart; s = mParent[s])
+		events += mMove[s];
+
+	std::reverse(events.begin(), events.end());
+	events += char(I_DOWN);						// Down from a placement locks
+}
+
+//***************************************************************************************
+//
+//	Function:	lock
+//	Purpose:	Locks a tetrad at a placement through the engine, clearing lines
+//				and advancing to the next tetrad as play would
+//	Return:		True if placement does not lock on this board
+//
+//***************************************************************************************
+bool cMoveGenerator::lock(cTrisEngine &board, const cPlacement &placement, int &cleared)
+{
+	cTetrad tetrad(placement.mType, board.width(), board.height());
+	int x[4];
+	int y[4];
+
+	for(int i(0); i < 4; i++)
+	{
+		x[i] = placement.mx + TETRAD_OFFSETS[placement.mType][placement.mRotation][i][0];
+		y[i] = placement.my + TETRAD_OFFSETS[placement.mType][placement.mRotation][i][1];
+	}
+
+	tetrad.setUnits(x, y);
+	board.setTetrad(tetrad);
+
+	return board.forceDown(cleared) <= 0;
+}
@@ -0,0 +1,107 @@
+//***************************************************************************************
+//
+//	Date Created:	October 17, 2026
+//	File:			movegen.h
+//	Project:		Blue Tetris
+//
+//	Purpose:		Class definition for the move generator, which lists every place
+//					a tetrad can be locked on a board using the moves a player has:
+//					left, right, rotations and down. Used by bots, search and
+//					validation tools.
+//
+//***************************************************************************************
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include "trisengine.h"
+using std::vector;
+using std::string;
+
+#define MOVEGEN_XOFFSET		2			// Origins may lie this far outside the board
+#define MOVEGEN_YOFFSET		2
+#define MOVEGEN_XSPAN		(BOARD_MAX_WIDTH + 2 * MOVEGEN_XOFFSET)
+#define MOVEGEN_YSPAN		(BOARD_MAX_HEIGHT + 2 * MOVEGEN_YOFFSET)
+#define MOVEGEN_STATES		(MOVEGEN_XSPAN * MOVEGEN_YSPAN * 4)	// (x, y, rotation)
+
+//***************************************************************************************
+//
+//	Class:		cPlacement
+//	Purpose:	Final resting place of a tetrad: the position from which moving
+//				down locks it
+//
+//***************************************************************************************
+class cPlacement
+{
+public:
+	int x(int i) { return mx + TETRAD_OFFSETS[mType][mRotation][i][0]; }
+	int y(int i) { return my + TETRAD_OFFSETS[mType][mRotation][i][1]; }
+
+	int mType;							// Tetrad type
+	int mRotation;						// Orientation index into TETRAD_OFFSETS
+	int mx;								// Origin on board
+	int my;
+	int mState;							// Search state, for path()
+};
+
+//***************************************************************************************
+//
+//	Class:		cMoveGenerator
+//	Purpose:	Breadth-first search over (x, y, rotation) from a tetrad's position.
+//				Collision is tested a row at a time against the board's bitboard.
+//				Placements covering the same units are listed once, reached by
+//				the shortest input sequence. Buffers are reused between searches.
+//
+//***************************************************************************************
+class cMoveGenerator
+{
+public:
+	cMoveGenerator();
+
+	int generate(cTrisEngine &board, vector<cPlacement> &out);	// From active tetrad
+	int generate(cTrisEngine &board, int type, vector<cPlacement> &out);	// From spawn
+	int generate(cTrisEngine &board, cTetrad tetrad, vector<cPlacement> &out);
+	int generate(const unsigned int rows[], int width, int height, int type,
+		vector<cPlacement> &out);				// From spawn, on bare row occupancy
+
+	void path(const cPlacement &placement, string &events);	// Inputs that lock placement
+	static bool lock(cTrisEngine &board, const cPlacement &placement, int &cleared);
+
+	long long nodes() { return mNodes; }		// Positions searched so far
+
+private:
+
+	int search(cTetrad &tetrad, vector<cPlacement> &out);	// Searches copied board
+	bool collides(int x, int y, int r);			// Tests position against board
+	int state(int x, int y, int r)
+		{ return ((y + MOVEGEN_YOFFSET) * MOVEGEN_XSPAN + x + MOVEGEN_XOFFSET) * 4 + r; }
+	void visit(int x, int y, int r, int from, int move);	// Queues unseen position
+	void nextStamp();							// Starts new generation of marks
+
+	// Shape of each orientation of each tetrad, as row masks from its lowest row
+	struct cShape
+	{
+		int mLeft, mRight, mBottom, mTop;		// Unit offset bounds
+		unsigned int mRows[4];					// Occupancy, shifted so mLeft is bit 0
+		int mCanonical;							// First orientation covering same units
+	};
+	cShape mShapes[7][4];
+
+	unsigned int mRows[BOARD_ROW_STORAGE];		// Copy of board being searched
+	int mWidth;
+	int mHeight;
+	int mType;
+
+	unsigned int mSeen[MOVEGEN_STATES];			// Stamp of search that reached state
+	unsigned int mPlaced[MOVEGEN_STATES];		// Stamp of search that listed placement
+	unsigned int mStamp;						// Current search
+	short mParent[MOVEGEN_STATES];				// State each state was reached from
+	char mMove[MOVEGEN_STATES];					// Input that reached each state
+	short mQueue[MOVEGEN_STATES];				// Search frontier
+	int mHead;
+	int mTail;
+	int mStart;									// State search began in
+
+	long long mNodes;							// Positions searched
+};
@@ -23,9 +23,13 @@
 #include "resource.h"
 #include "keymap.h"
 #include "socketConnection.h"
+#include "boardsync.h"
+#include "replay.h"
 using std::queue;
 using std::vector;
 
+#define MP_REPLAYFILE		"Data/lastmatch.btr"	// Replay of most recent match
+
 //***************************************************************************************
 //
 //	Class:		cMultiplayer
@@ -63,8 +67,10 @@ private:
 	bool initConnection();				// Initiate connection
 	void sendMessage(int state, int message);	// Translate into message and enqueue
 	int readMessage();					// Grab message from incoming queue and execute
-	void sendLockMessage(int units[]);	// Reports locking of units
+	void recordInput(int event);		// Logs input event for server replay
+	void reportInputs();				// Sends this frame's input events
 	void reportTetrad();				// Reports the location of the falling tetrad
+	unsigned long long elapsed();		// Milliseconds since game began
 
 	void requestFix(int id);			// Requests server's state of specified board
 
@@ -103,6 +109,10 @@ private:
 	SOCKET mConn;						// Socket for server communication
 	int mPlayerID;						// ID of this player
 	int mPlayerCount;					// Number of players in this game
+	int mFrame;							// Game frame number, stamped on input events
+	string mInputs;						// Input events not yet sent
+	cBoardImage mSynced[4];				// Boards as of last resync applied
+	cReplayWriter mReplay;				// Records this player's board
 
 	bool mKeylist[7];					// Array for keydown tracking
 	int mRepeat[7];						// Array for key repeat tracking
@@ -117,7 +127,7 @@ private:
 cMultiplayer::cMultiplayer(bool* present, int playerID, cKeymap keymap, 
 						   cConnection* connection, cTexture texture, bool* frame, bool* grid, int* face):
 mKeymap(keymap), mConnection(connection), mLocalState(0),
-mPlayerID(playerID), mTexture(texture), mGameState(S_ROOM)
+mPlayerID(playerID), mTexture(texture), mGameState(S_ROOM), mFrame(0)
 {
 	mPlayerCount = 0;
 
@@ -150,6 +160,8 @@ int cMultiplayer::advance(vector<int> keys)
 	if(mLocalState == 0)			// 1. Initiate and Report
 	{
 		initBoardMetrics();
+		mReplay.open(MP_REPLAYFILE, 0, mBoard[mPlayerID].width(),
+			mBoard[mPlayerID].height(), mBoard[mPlayerID].level(), REPLAY_SERVER);
 
 		sendMessage(S_ROOM, M_ENTER_GAME_STATE);	// Report ready state
 		mLocalState++;
@@ -197,6 +209,9 @@ int cMultiplayer::advance(vector<int> keys)
 
 		if(temp != 0)
 			returnVal = temp;
+
+		reportInputs();				// Server replays this frame's input
+		mFrame++;
 	}
 
 	reportDelay++;
@@ -326,32 +341,35 @@ int cMultiplayer::executeCommand()
 	{
 		int units[12];
 		int cleared;
+		recordInput(I_SONIC_LOCK);
 		if(mBoard[mPlayerID].sonicLock(cleared, units))
-		{
 			playSound(SOUND_LOCK);
-			sendLockMessage(units);
-		}
 	}
 
 	if(mKeylist[ARRAY_DOWN] && (mRepeat[ARRAY_DOWN] == 0 || mRepeat[ARRAY_DOWN] > 3) )
 	{
 		int units[12];
 		int cleared;
+		recordInput(I_DOWN);
 		if(mBoard[mPlayerID].moveDown(cleared, units))
-		{
 			playSound(SOUND_LOCK);
-			sendLockMessage(units);
-		}
 	}
 
 	if(mKeylist[ARRAY_RIGHT] && (mRepeat[ARRAY_RIGHT] == 0 || mRepeat[ARRAY_RIGHT] > 3) )
+	{
+		recordInput(I_RIGHT);
 		mBoard[mPlayerID].moveRight();
+	}
 
 	if(mKeylist[ARRAY_LEFT] && (mRepeat[ARRAY_LEFT] == 0 || mRepeat[ARRAY_LEFT] > 3) )
+	{
+		recordInput(I_LEFT);
 		mBoard[mPlayerID].moveLeft();
+	}
 
 	if(mKeylist[ARRAY_ROTATE_LEFT] && !mRepeat[ARRAY_ROTATE_LEFT])
 	{
+		recordInput(I_ROTATE_LEFT);
 		rvalue = mBoard[mPlayerID].rotateLeft();
 
 		if(rvalue == 1)
@@ -362,6 +380,7 @@ int cMultiplayer::executeCommand()
 
 	if(mKeylist[ARRAY_ROTATE_RIGHT] && !mRepeat[ARRAY_ROTATE_RIGHT])
 	{
+		recordInput(I_ROTATE_RIGHT);
 		rvalue = mBoard[mPlayerID].rotateRight();
 
 		if(rvalue == 1)
@@ -376,6 +395,7 @@ int cMultiplayer::executeCommand()
 	{
 		mTotalTime = CFileTime::GetTickCount() - mStartTime;
 		mBoardState = BS_POSTGAME;
+		mReplay.close();
 	}
 
 	return rvalue;
@@ -398,11 +418,9 @@ void cMultiplayer::forceCheck()
 		mLastDropTime += BTDropInterval(mBoard[mPlayerID].level()) * 10000;
 		timeDiff = CFileTime::GetCurrentTime() - mLastDropTime;
 
+		recordInput(I_GRAVITY);
 		if(mBoard[mPlayerID].forceDown(cleared, units))			// Force tetrad downward
-		{
 			playSound(SOUND_LOCK);
-			sendLockMessage(units);
-		}
 
 		if(cleared > 0)							// Report any line clears
 			clearMessage(cleared);
@@ -424,8 +442,7 @@ bool cMultiplayer::initConnection()
 	hostent *hp;
 	sockaddr_in server;
 	unsigned int addr;
-	int r;											// Message return value
-	char buff[MESSAGE_BUFFSIZE];					// Message buffer
+	string message;									// First message from server
 	WSADATA wsaData;
 
 	sprintf(mServerName, DEFAULT_IP);				// Default servername
@@ -473,23 +490,17 @@ bool cMultiplayer::initConnection()
 
 				if(!error)
 				{
-					r=recv(mConn,buff,MESSAGE_BUFFSIZE,0);	// Get response from server
-					buff[r]=0;
-
-					if(r != 3)								// Check for correct message
+					if(BTCReceiveFrame(mConn, message))	// Get response from server
+					{
 						error = true;
+						printf(" -Socket Error\n");
+					}
 					else
 					{
-						buff[r] = '\0';						// Add null terminator
 						ASSERT(mIncoming.empty());
-						mIncoming.push(string(buff));		// Push message on queue
+						mIncoming.push(message);			// Push message on queue
 						handleGlobal();
-					}
 
-					if(r==SOCKET_ERROR)
-						printf(" -Socket Error\n");
-					else
-					{
 						printf(" -Connection established.\n");
 
 						AfxBeginThread(BTCRead, (LPVOID)mConn);	// Start reading thread
@@ -517,26 +528,63 @@ void cMultiplayer::sendMessage(int state, int message)
 
 //**************************************************************************************
 //
-//	Function:	sendLockMessage
-//	Purpose:	Reports lockdown of a tetrad
+//	Function:	recordInput
+//	Purpose:	Logs an input event, stamped with the frame number, for the server
+//				to replay on its copy of the board. Called before the command is
+//				executed. Events with no falling tetrad are kept from the server,
+//				whose board already holds its first tetrad, but go into the replay:
+//				the step that brings in the first tetrad happens on every board
+//				the replay is played back on.
 //
 //**************************************************************************************
-void cMultiplayer::sendLockMessage(int units[])
+void cMultiplayer::recordInput(int event)
 {
-	int n(0);
-	string message;
-	message += S_GAME * 8 + BT_CODE * 32;
-	message += M_LOCKDOWN;
-
-	for(int i(0); i < 4; i++)
+	if(mBoard[mPlayerID].getTetradPtr())
 	{
-		message += units[n++] + NUMERAL_OFFSET;
-		message += units[n++] + NUMERAL_OFFSET;
-		message += units[n++] + NUMERAL_OFFSET;
+		mInputs += char(event);
+		mInputs += char(mFrame >> 8 & 0xFF);
+		mInputs += char(mFrame & 0xFF);
 	}
-	message += '\0';
 
-	enqueue(message);
+	mReplay.record(event, elapsed());
+}
+
+//**************************************************************************************
+//
+//	Function:	elapsed
+//	Purpose:	Measures time in play, for replay records
+//	Return:		Milliseconds since game began; 0 before it begins
+//
+//**************************************************************************************
+unsigned long long cMultiplayer::elapsed()
+{
+	if(mLocalState < 3)
+		return 0;
+
+	CFileTimeSpan time = CFileTime::GetCurrentTime() - mStartTime;
+
+	return time.GetTimeSpan() / 10000;
+}
+
+//**************************************************************************************
+//
+//	Function:	reportInputs
+//	Purpose:	Sends input events logged this frame in one message. The server
+//				reports resulting lockdowns to the other players.
+//
+//**************************************************************************************
+void cMultiplayer::reportInputs()
+{
+	if(!mInputs.empty())
+	{
+		string message;
+		message += S_GAME * 8 + BT_CODE * 32;
+		message += M_INPUT;
+		message += mInputs;
+
+		enqueue(message);
+		mInputs.clear();
+	}
 }
 
 //**************************************************************************************
@@ -641,30 +689,22 @@ bool cMultiplayer::lockdown(string message)
 //***************************************************************************************
 //
 //	Function:	fixBoard
-//	Purpose:	Specifies contents of player's board
+//	Purpose:	Applies the server's resync of a player's board. A resync
+//				based on a revision this client does not hold is discarded and
+//				the whole board is requested.
 //
 //***************************************************************************************
 void cMultiplayer::fixBoard(string message)
 {
 	int id = message[0] & 7;
-	int n(2);
-
-	int mxSize = mBoard[id].width();
-	int mySize = mBoard[id].height();
 
-	if(id >= 0 && id <= 4)
+	if(id >= 0 && id < 4 && message.length() >= 2)
 	{
-		for(int y(0); y < mySize; y++)
+		if(mSynced[id].apply(mBoard[id], message.data() + 2, (int)message.length() - 2)
+			&& mSynced[id].revision() != SYNC_NO_BASE)
 		{
-			for(int x(0); x < mxSize; x++)
-			{
-				if(message[n] == -1)
-					mBoard[id].erase(x, y);
-				else
-					mBoard[id].add(x, y, message[n] - NUMERAL_OFFSET);
-
-				n++;
-			}
+			mSynced[id].clear();				// Lost track; ask for whole board
+			requestFix(id);
 		}
 	}
 }
@@ -686,6 +726,9 @@ void cMultiplayer::setNext(string message)
 			next[i] = message[i + 2] - NUMERAL_OFFSET;
 
 		mBoard[id].setNext(next);
+
+		if(id == mPlayerID)
+			mReplay.recordList(next, elapsed());
 	}
 }
 
@@ -693,16 +736,21 @@ void cMultiplayer::setNext(string message)
 //
 //	Function:	requestFix
 //	Purpose:	Requests fixBoard message for specified player
-//				Used to fix client-side inconsistancies for opponent boards
+//				Used to fix client-side inconsistancies for opponent boards.
+//				Acknowledges the revision of the last resync applied; the server
+//				sends the rows changed since, which fixBoard lays over that image.
 //
 //***************************************************************************************
 void cMultiplayer::requestFix(int id)
 {
 	string message;
+	int revision = mSynced[id].revision();
+
 	message += mGameState * 8 + BT_CODE * 32;
 	message += M_REQUEST_FIX;
 	message += id + NUMERAL_OFFSET;
-	message += '\0';
+	message += char(revision >> 8 & 0xFF);
+	message += char(revision & 0xFF);
 
 	enqueue(message);
 }
@@ -726,8 +774,8 @@ void cMultiplayer::reportTetrad()
 		
 		for(int i(0); i < 4; i++)
 		{
-			message += tetrad->unit(i)->x() + NUMERAL_OFFSET;
-			message += tetrad->unit(i)->y() + NUMERAL_OFFSET;
+			message += tetrad->x(i) + NUMERAL_OFFSET;
+			message += tetrad->y(i) + NUMERAL_OFFSET;
 		}
 	}
 }
@@ -755,10 +803,9 @@ void cMultiplayer::updateTetrad(string message)
 			y[i] = message[n++] - NUMERAL_OFFSET;
 		}
 
-		cTetrad* tetrad = mBoard[id].getTetradPtr();
-		if(!tetrad)
-			tetrad = new cTetrad(type, mBoard[id].width(), mBoard[id].height());
-		tetrad->setUnits(x, y);	// Set coordinates
+		cTetrad tetrad(type, mBoard[id].width(), mBoard[id].height());
+		tetrad.setUnits(x, y);	// Set coordinates
+		mBoard[id].setTetrad(tetrad);
 	}
 }
 
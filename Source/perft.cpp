@@ -0,0 +1,201 @@
+//***************************************************************************************
+//
+//	Date Created:	October 17, 2026
+//	File:			perft.cpp
+//	Project:		Blue Tetris
+//
+//	Purpose:		Move generator benchmark. Counts the placement sequences
+//					reachable to a given depth from a set of canonical boards and
+//					tetrad sequences, checks the counts against known values and
+//					reports search speed.
+//
+//					btperft [-d depth] [-b board]
+//						-d depth		Deepest level counted (default 3)
+//						-b board		Only run the named board
+//
+//***************************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include "movegen.h"
+
+#define PERFT_DEPTH		3				// Default depth
+#define PERFT_MAXDEPTH	8				// Deepest supported search
+#define PERFT_KNOWN		4				// Depths with known counts, from 1
+
+//***************************************************************************************
+//
+//	Struct:		sPerftCase
+//	Purpose:	Canonical position: board rows from the bottom ('#' occupied),
+//				tetrad sequence (IOLJSZT) and known counts by depth
+//
+//***************************************************************************************
+struct sPerftCase
+{
+	const char* mName;
+	const char* mRows[8];
+	const char* mSequence;
+	long long mKnown[PERFT_KNOWN];
+};
+
+const sPerftCase PERFT_CASES[] = {
+	{ "empty", { NULL }, "TIOLJSZT", { 34, 596, 5542, 198763 } },
+	{ "well", {
+		"#########.",
+		"#########.",
+		"#########.",
+		"#########.", NULL }, "IJLTSZOI", { 17, 578, 20312, 740653 } },
+	{ "ragged", {
+		"##.####.##",
+		"#.###.####",
+		".####.###.",
+		"..#...##..",
+		"......#...", NULL }, "SZTLJIOT", { 17, 296, 10635, 387689 } },
+	{ "tslot", {
+		"####..####",
+		"###...####",
+		"###.######", NULL }, "TTOIJLSZ", { 34, 1187, 10961, 194891 } }
+};
+
+#define PERFT_CASECOUNT	(int)(sizeof(PERFT_CASES) / sizeof(PERFT_CASES[0]))
+
+//***************************************************************************************
+//
+//	Class:		cPerft
+//	Purpose:	Counts placement sequences by depth-first search
+//
+//***************************************************************************************
+class cPerft
+{
+public:
+	cPerft(const char* sequence): mSequence(sequence) {}
+
+	long long count(cTrisEngine &board, int depth, int ply = 0);
+	long long nodes() { return mGenerator.nodes(); }
+
+private:
+
+	cMoveGenerator mGenerator;
+	vector<cPlacement> mPlacements[PERFT_MAXDEPTH];	// One list per ply
+	const char* mSequence;					// Tetrad letters, one per ply
+};
+
+//***************************************************************************************
+//
+//	Function:	count
+//	Purpose:	Counts sequences of placements of the remaining tetrads. Each
+//				placement is locked through the engine, so line clears and
+//				game over apply as in play.
+//	Return:		Number of sequences of the given length
+//
+//***************************************************************************************
+long long cPerft::count(cTrisEngine &board, int depth, int ply)
+{
+	const char* letters = "IOLJSZT";
+	vector<cPlacement> &placements = mPlacements[ply];
+	int type = (int)(strchr(letters, mSequence[ply]) - letters);
+	int cleared;
+	long long total(0);
+
+	mGenerator.generate(board, type, placements);
+
+	if(depth == 1)
+		return (long long)placements.size();
+
+	for(unsigned int i(0); i < placements.size(); i++)
+	{
+		cTrisEngine next(board);
+
+		cMoveGenerator::lock(next, placements[i], cleared);
+		if(!next.gameOver())
+			total += count(next, depth - 1, ply + 1);
+	}
+
+	return total;
+}
+
+//***************************************************************************************
+//
+//	Function:	setup
+//	Purpose:	Builds a case's board
+//
+//***************************************************************************************
+void setup(const sPerftCase &perftCase, cTrisEngine &board)
+{
+	board = cTrisEngine(BOARDWIDTH, BOARDDEPTH, true, 0);
+	board.setAutonomy(false);				// Tetrads come from the case, not a seed
+
+	for(int y(0); y < 8 && perftCase.mRows[y]; y++)
+		for(int x(0); x < BOARDWIDTH && perftCase.mRows[y][x]; x++)
+			if(perftCase.mRows[y][x] == '#')
+				board.add(x, y, 0);
+}
+
+int main(int argc, char* argv[])
+{
+	int depth(PERFT_DEPTH);
+	const char* only = NULL;
+	bool mismatch(false);
+
+	for(int i(1); i + 1 < argc; i += 2)
+	{
+		if(!strcmp(argv[i], "-d"))
+			depth = atoi(argv[i + 1]);
+		else if(!strcmp(argv[i], "-b"))
+			only = argv[i + 1];
+	}
+
+	if(depth < 1 || depth > PERFT_MAXDEPTH)
+	{
+		printf("| Depth must be 1 to %d\n", PERFT_MAXDEPTH);
+		return 1;
+	}
+
+	printf("| Blue Tetris Perft\n\n");
+
+	long long allNodes(0);
+	double allSeconds(0);
+
+	for(int c(0); c < PERFT_CASECOUNT; c++)
+	{
+		const sPerftCase &perftCase = PERFT_CASES[c];
+		cTrisEngine board;
+
+		if(only && strcmp(only, perftCase.mName))
+			continue;
+
+		setup(perftCase, board);
+		printf("| %s (%.*s)\n", perftCase.mName, depth, perftCase.mSequence);
+
+		for(int d(1); d <= depth; d++)
+		{
+			cPerft perft(perftCase.mSequence);
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+			long long total = perft.count(board, d);
+
+			std::chrono::duration<double> span = std::chrono::steady_clock::now() - start;
+			double seconds = span.count() > 0 ? span.count() : 1e-9;
+			const char* verdict = "";
+
+			if(d <= PERFT_KNOWN && perftCase.mKnown[d - 1])
+			{
+				verdict = (total == perftCase.mKnown[d - 1]) ? "  ok" : "  MISMATCH";
+				mismatch = mismatch || total != perftCase.mKnown[d - 1];
+			}
+
+			printf("|   depth %d  %14lld  %9.3f s  %12.0f nodes/s%s\n",
+				d, total, seconds, perft.nodes() / seconds, verdict);
+
+			allNodes += perft.nodes();
+			allSeconds += seconds;
+		}
+	}
+
+	if(allSeconds > 0)
+		printf("\n| Total: %lld nodes, %.0f nodes/s\n", allNodes, allNodes / allSeconds);
+
+	return mismatch ? 1 : 0;
+}
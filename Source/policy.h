@@ -0,0 +1,229 @@
+//***************************************************************************************
+//
+//	Date Created:	October 17, 2026
+//	File:			policy.h
+//	Project:		Blue Tetris
+//
+//	Purpose:		Input policies for headless play. A policy chooses the input
+//					event (I_*) to apply to a board next, in place of a player at
+//					the keyboard.
+//
+//***************************************************************************************
+
+#pragma once
+
+#include <string>
+#include <string.h>
+#include <ctype.h>
+#include "resource.h"
+#include "trisengine.h"
+#include "replay.h"
+#include "random.h"
+using std::string;
+
+#define POLICY_STOP			0			// next(): no more input for this game
+
+//***************************************************************************************
+//
+//	Class:		cPolicy
+//	Purpose:	Interface for input sources driving a headless board
+//
+//***************************************************************************************
+class cPolicy
+{
+public:
+	virtual ~cPolicy() {}
+
+	virtual bool begin(cTrisEngine &board, int game);	// Starts a game on board
+	virtual int next(cTrisEngine &board) = 0;	// Chooses next input event
+
+	void setSeed(unsigned long long seed) { mSeed = seed; }
+
+protected:
+
+	cPolicy(): mSeed(0) {}
+
+	unsigned long long mSeed;					// Seed for first game's board
+};
+
+//***************************************************************************************
+//
+//	Class:		cRandomPolicy
+//	Purpose:	Presses a uniformly random key each step
+//
+//***************************************************************************************
+class cRandomPolicy: public cPolicy
+{
+public:
+	cRandomPolicy(unsigned long long seed) { mRandom.seed(seed, RANDOM_DEFAULT_STREAM ^ 1); }
+
+	virtual int next(cTrisEngine &/*board*/) { return I_LEFT + mRandom.range(I_GRAVITY); }
+
+private:
+
+	cRandom mRandom;							// Kept apart from the boards' generators
+};
+
+//***************************************************************************************
+//
+//	Class:		cScriptPolicy
+//	Purpose:	Repeats a fixed key sequence. Keys are written as letters:
+//				L left, R right, D down, S sonic lock, A rotate left,
+//				B rotate right, G gravity.
+//
+//***************************************************************************************
+class cScriptPolicy: public cPolicy
+{
+public:
+	cScriptPolicy(): mStep(0) {}
+
+	bool load(const string &script);			// Reads key letters
+	virtual bool begin(cTrisEngine &board, int game);
+	virtual int next(cTrisEngine &board);
+
+private:
+
+	string mEvents;								// Events in order
+	unsigned int mStep;							// Next event to apply
+};
+
+//***************************************************************************************
+//
+//	Class:		cReplayPolicy
+//	Purpose:	Plays back a recorded game; every game replays it from the start
+//
+//***************************************************************************************
+class cReplayPolicy: public cPolicy
+{
+public:
+	cReplayPolicy(): mLoaded(false) {}
+
+	bool open(const char* path) { mLoaded = !mStart.open(path); return !mLoaded; }
+
+	virtual bool begin(cTrisEngine &board, int game);
+	virtual int next(cTrisEngine &board);
+
+private:
+
+	cReplayReader mStart;						// Replay as loaded, for rewinding
+	cReplayReader mReader;						// Replay being played
+	bool mLoaded;								// Flags valid replay in mStart
+};
+
+//***************************************************************************************
+//
+//	Function:	begin
+//	Purpose:	Starts a fresh game on board, keeping its metrics and options.
+//				Each game gets its own seed so games differ.
+//	Return:		True if the game cannot be started
+//
+//***************************************************************************************
+inline bool cPolicy::begin(cTrisEngine &board, int game)
+{
+	board = cTrisEngine(board.width(), board.height(), board.permutation(), board.level());
+	board.setSeed(mSeed + game);
+	board.start();
+
+	return false;
+}
+
+//***************************************************************************************
+//
+//	Function:	load
+//	Purpose:	Translates key letters into input events
+//	Return:		True if script is empty or holds an unknown letter
+//
+//***************************************************************************************
+inline bool cScriptPolicy::load(const string &script)
+{
+	const char* keys = "LRDSABG";				// In I_* order
+	const char* key;
+	bool invalid(script.empty());
+
+	mEvents.clear();
+
+	for(unsigned int i(0); i < script.length() && !invalid; i++)
+	{
+		key = strchr(keys, toupper((unsigned char)script[i]));
+
+		if(key && *key)
+			mEvents += char(I_LEFT + (key - keys));
+		else
+			invalid = true;
+	}
+
+	return invalid;
+}
+
+//***************************************************************************************
+//
+//	Function:	begin
+//	Purpose:	Starts script from its first key on a fresh game
+//	Return:		True if the game cannot be started
+//
+//***************************************************************************************
+inline bool cScriptPolicy::begin(cTrisEngine &board, int game)
+{
+	mStep = 0;
+	return cPolicy::begin(board, game);
+}
+
+//***************************************************************************************
+//
+//	Function:	next
+//	Purpose:	Reads the next key of the script, wrapping at its end
+//	Return:		Input event; POLICY_STOP if no script is loaded
+//
+//***************************************************************************************
+inline int cScriptPolicy::next(cTrisEngine &/*board*/)
+{
+	if(mEvents.empty())
+		return POLICY_STOP;
+
+	if(mStep >= mEvents.length())
+		mStep = 0;
+
+	return mEvents[mStep++];
+}
+
+//***************************************************************************************
+//
+//	Function:	begin
+//	Purpose:	Rewinds replay and starts board as it was recorded
+//	Return:		True if no replay is loaded
+//
+//***************************************************************************************
+inline bool cReplayPolicy::begin(cTrisEngine &board, int /*game*/)
+{
+	if(!mLoaded)
+		return true;
+
+	mReader = mStart;
+	mReader.prepare(board);
+
+	return false;
+}
+
+//***************************************************************************************
+//
+//	Function:	next
+//	Purpose:	Reads the next recorded input, handing recorded tetrad lists to
+//				the board on the way
+//	Return:		Input event; POLICY_STOP at end of replay
+//
+//***************************************************************************************
+inline int cReplayPolicy::next(cTrisEngine &board)
+{
+	unsigned long long time;
+	int event;
+
+	while(!mReader.next(event, time))
+	{
+		if(event == REPLAY_EVENT_LIST)
+			board.setNext(mReader.list());
+		else
+			return event;
+	}
+
+	return POLICY_STOP;
+}
@@ -0,0 +1,108 @@
+//***************************************************************************************
+//
+//	Date Created:	October 17, 2026
+//	File:			random.h
+//	Project:		Blue Tetris
+//
+//	Purpose:		Small seeded random number generator (PCG32). Each board owns
+//					one, so a board's tetrad sequence depends only on its seed and
+//					boards on different threads never share generator state.
+//
+//***************************************************************************************
+
+#pragma once
+
+#define RANDOM_DEFAULT_SEED		0x853C49E6748FEA9BULL	// Used until a board is seeded
+#define RANDOM_DEFAULT_STREAM	0xDA3E39CB94B95BDBULL	// Sequence selector
+#define RANDOM_MULTIPLIER		6364136223846793005ULL	// LCG step
+
+//***************************************************************************************
+//
+//	Class:		cRandom
+//	Purpose:	Permuted congruential generator: a 64-bit linear congruential state
+//				whose output is scrambled down to 32 bits. The state and stream may
+//				be read and restored to reproduce a sequence from any point.
+//
+//***************************************************************************************
+class cRandom
+{
+public:
+	cRandom() { seed(RANDOM_DEFAULT_SEED); }
+	cRandom(unsigned long long value) { seed(value); }
+
+	void seed(unsigned long long value, unsigned long long stream = RANDOM_DEFAULT_STREAM);
+	unsigned int next();						// Returns 32 random bits
+	int range(int n);							// Returns uniform value in [0, n)
+
+	unsigned long long state() { return mState; }
+	unsigned long long stream() { return mIncrement; }
+	void setState(unsigned long long state, unsigned long long stream)
+		{ mState = state; mIncrement = stream | 1; }
+
+private:
+
+	unsigned long long mState;					// Generator state
+	unsigned long long mIncrement;				// Stream; always odd
+};
+
+//***************************************************************************************
+//
+//	Function:	seed
+//	Purpose:	Starts the sequence chosen by the given seed and stream
+//
+//***************************************************************************************
+inline void cRandom::seed(unsigned long long value, unsigned long long stream)
+{
+	mState = 0;
+	mIncrement = stream << 1 | 1;
+	next();
+	mState += value;
+	next();
+}
+
+//***************************************************************************************
+//
+//	Function:	next
+//	Purpose:	Advances the state and returns its scrambled high bits
+//	Return:		32 random bits
+//
+//***************************************************************************************
+inline unsigned int cRandom::next()
+{
+	unsigned long long old = mState;
+	unsigned int shifted;
+	unsigned int rotation;
+
+	mState = old * RANDOM_MULTIPLIER + mIncrement;
+
+	shifted = (unsigned int)(((old >> 18) ^ old) >> 27);
+	rotation = (unsigned int)(old >> 59);
+
+	return (shifted >> rotation) | (shifted << ((0u - rotation) & 31));
+}
+
+//***************************************************************************************
+//
+//	Function:	range
+//	Purpose:	Draws a value below n without modulo bias
+//	Return:		Value in [0, n); 0 if n is not positive
+//
+//***************************************************************************************
+inline int cRandom::range(int n)
+{
+	unsigned int bound;
+	unsigned int threshold;
+	unsigned int value;
+
+	if(n <= 0)
+		return 0;
+
+	bound = (unsigned int)n;
+	threshold = (0u - bound) % bound;			// Values below this would favour low results
+
+	do
+		value = next();
+	while(value < threshold);
+
+	return (int)(value % bound);
+}
@@ -0,0 +1,491 @@
+//***************************************************************************************
+//
+//	Date Created:	October 17, 2026
+//	File:			replay.h
+//	Project:		Blue Tetris
+//
+//	Purpose:		Game recording and playback. A replay holds the seed and
+//					settings a board was started with and every input event applied
+//					to it, so the game can be reproduced on a headless engine as fast
+//					as the engine allows.
+//
+//					File layout (integers are unsigned LEB128 varints):
+//						"BTRP", version byte, seed, width, height, level, flags
+//						records: (time delta << 3 | event)
+//					Events 1 to 7 are the input codes I_*. Event 0 is followed by a
+//					control byte: REPLAY_END, or REPLAY_NEXT and seven tetrad types
+//					for boards whose tetrad lists come from the server.
+//					Times are milliseconds since the game began.
+//
+//***************************************************************************************
+
+#pragma once
+
+#include <stdio.h>
+#include <string>
+#include "resource.h"
+#include "trisengine.h"
+using std::string;
+
+#define REPLAY_MAGIC		"BTRP"		// File signature
+#define REPLAY_VERSION		1			// Format version
+#define REPLAY_BUFFERSIZE	4096		// Bytes gathered before each write
+
+#define REPLAY_PERMUTE		1			// Flags: tetrad lists are permutations
+#define REPLAY_SERVER		2			// Flags: tetrad lists are recorded
+
+#define REPLAY_END			0			// Control codes
+#define REPLAY_NEXT			1
+
+#define REPLAY_EVENT_LIST	8			// next(): tetrad list record; see list()
+
+//***************************************************************************************
+//
+//	Class:		cReplayWriter
+//	Purpose:	Streams a game's inputs to a replay file
+//
+//***************************************************************************************
+class cReplayWriter
+{
+public:
+	cReplayWriter(): mFile(NULL), mTime(0) {}
+	~cReplayWriter() { close(); }
+
+	bool open(const char* path, unsigned long long seed, int width, int height,
+		int level, int flags);					// Starts new replay file
+	void record(int event, unsigned long long time);	// Logs input event
+	void recordList(int list[], unsigned long long time);	// Logs tetrad list
+	void close();								// Ends replay and closes file
+
+	bool recording() { return mFile != NULL; }
+
+private:
+
+	cReplayWriter(const cReplayWriter&);		// Not copyable: owns file
+	cReplayWriter& operator=(const cReplayWriter&);
+
+	void varint(unsigned long long value);		// Appends varint to buffer
+	void stamp(int event, unsigned long long time);	// Appends record header
+	void flush();								// Writes buffer to file
+
+	FILE* mFile;								// Replay file; NULL if idle
+	string mBuffer;								// Bytes not yet written
+	unsigned long long mTime;					// Time of last record
+};
+
+//***************************************************************************************
+//
+//	Class:		cReplayReader
+//	Purpose:	Reads a replay and plays it back on a board
+//
+//***************************************************************************************
+class cReplayReader
+{
+public:
+	cReplayReader(): mPosition(0), mTime(0), mSeed(0), mWidth(BOARDWIDTH),
+		mHeight(BOARDDEPTH), mLevel(0), mFlags(REPLAY_PERMUTE), mCorrupt(false) {}
+
+	bool open(const char* path);				// Loads replay file
+	bool load(const string &data);				// Loads replay from memory
+	bool next(int &event, unsigned long long &time);	// Reads next record
+
+	void prepare(cTrisEngine &board);			// Starts board as recorded
+	int play(cTrisEngine &board);				// Plays all remaining records
+	static int execute(cTrisEngine &board, int event);	// Applies one input event
+
+	unsigned long long seed() { return mSeed; }
+	int width() { return mWidth; }
+	int height() { return mHeight; }
+	int level() { return mLevel; }
+	int flags() { return mFlags; }
+	int* list() { return mList; }				// Tetrad list of last REPLAY_EVENT_LIST
+	bool corrupt() { return mCorrupt; }			// True if replay ended unexpectedly
+
+private:
+
+	bool varint(unsigned long long &value);		// Reads varint; true if truncated
+
+	string mData;								// Replay contents
+	unsigned int mPosition;						// Read position in mData
+	unsigned long long mTime;					// Time of last record
+
+	unsigned long long mSeed;					// Recorded settings
+	int mWidth;
+	int mHeight;
+	int mLevel;
+	int mFlags;
+
+	int mList[7];								// Last tetrad list read
+	bool mCorrupt;								// Flags bad or truncated data
+};
+
+//***************************************************************************************
+//
+//	Function:	open
+//	Purpose:	Creates replay file and writes the game's seed and settings.
+//				Any replay already being written is closed first.
+//	Return:		True if file could not be created
+//
+//***************************************************************************************
+inline bool cReplayWriter::open(const char* path, unsigned long long seed, int width,
+	int height, int level, int flags)
+{
+	close();
+
+	mFile = fopen(path, "wb");
+	if(!mFile)
+		return true;
+
+	mBuffer.reserve(REPLAY_BUFFERSIZE);
+	mBuffer = REPLAY_MAGIC;
+	mBuffer += char(REPLAY_VERSION);
+	varint(seed);
+	varint(width);
+	varint(height);
+	varint(level);
+	varint(flags);
+	mTime = 0;
+
+	return false;
+}
+
+//***************************************************************************************
+//
+//	Function:	record
+//	Purpose:	Logs an input event (I_*) applied at the given time
+//
+//***************************************************************************************
+inline void cReplayWriter::record(int event, unsigned long long time)
+{
+	if(mFile && event >= I_LEFT && event <= I_GRAVITY)
+	{
+		stamp(event, time);
+
+		if(mBuffer.length() >= REPLAY_BUFFERSIZE)
+			flush();
+	}
+}
+
+//***************************************************************************************
+//
+//	Function:	recordList
+//	Purpose:	Logs a tetrad list handed to the board at the given time
+//
+//***************************************************************************************
+inline void cReplayWriter::recordList(int list[], unsigned long long time)
+{
+	if(mFile)
+	{
+		stamp(0, time);
+		mBuffer += char(REPLAY_NEXT);
+
+		for(int i(0); i < 7; i++)
+			mBuffer += char(list[i]);
+
+		if(mBuffer.length() >= REPLAY_BUFFERSIZE)
+			flush();
+	}
+}
+
+//***************************************************************************************
+//
+//	Function:	close
+//	Purpose:	Writes end record and closes replay file
+//
+//***************************************************************************************
+inline void cReplayWriter::close()
+{
+	if(mFile)
+	{
+		stamp(0, mTime);
+		mBuffer += char(REPLAY_END);
+		flush();
+
+		fclose(mFile);
+		mFile = NULL;
+	}
+}
+
+//***************************************************************************************
+//
+//	Function:	stamp
+//	Purpose:	Appends record header: time since the last record and event code.
+//				Time running backwards is recorded as no time passing.
+//
+//***************************************************************************************
+inline void cReplayWriter::stamp(int event, unsigned long long time)
+{
+	unsigned long long delta(0);
+
+	if(time > mTime)
+	{
+		delta = time - mTime;
+		mTime = time;
+	}
+
+	varint(delta << 3 | event);
+}
+
+//***************************************************************************************
+//
+//	Function:	varint
+//	Purpose:	Appends value seven bits at a time, low bits first; the top bit of
+//				each byte flags that more follow
+//
+//***************************************************************************************
+inline void cReplayWriter::varint(unsigned long long value)
+{
+	while(value >= 0x80)
+	{
+		mBuffer += char((value & 0x7F) | 0x80);
+		value >>= 7;
+	}
+
+	mBuffer += char(value);
+}
+
+//***************************************************************************************
+//
+//	Function:	flush
+//	Purpose:	Writes buffered records to file
+//
+//***************************************************************************************
+inline void cReplayWriter::flush()
+{
+	if(mFile && !mBuffer.empty())
+	{
+		fwrite(mBuffer.data(), 1, mBuffer.length(), mFile);
+		mBuffer.clear();
+	}
+}
+
+//***************************************************************************************
+//
+//	Function:	open
+//	Purpose:	Loads a replay file
+//	Return:		True if file cannot be read or is not a valid replay
+//
+//***************************************************************************************
+inline bool cReplayReader::open(const char* path)
+{
+	FILE* file = fopen(path, "rb");
+	string data;
+	char buffer[REPLAY_BUFFERSIZE];
+	size_t count;
+
+	if(!file)
+		return true;
+
+	while((count = fread(buffer, 1, sizeof(buffer), file)) > 0)
+		data.append(buffer, count);
+
+	fclose(file);
+
+	return load(data);
+}
+
+//***************************************************************************************
+//
+//	Function:	load
+//	Purpose:	Reads the seed and settings at the start of a replay
+//	Return:		True if data is not a valid replay
+//
+//***************************************************************************************
+inline bool cReplayReader::load(const string &data)
+{
+	unsigned long long value[5];
+	bool invalid(false);
+
+	mData = data;
+	mPosition = 5;
+	mTime = 0;
+	mCorrupt = false;
+
+	if(mData.length() < 5 || mData.compare(0, 4, REPLAY_MAGIC) != 0 ||
+		mData[4] != REPLAY_VERSION)
+		invalid = true;
+
+	for(int i(0); i < 5 && !invalid; i++)
+		invalid = varint(value[i]);
+
+	if(!invalid)
+	{
+		mSeed = value[0];
+		invalid = (value[1] < 4 || value[1] > BOARD_MAX_WIDTH ||
+			value[2] < 6 || value[2] > BOARD_MAX_HEIGHT || value[3] > 100);
+	}
+
+	if(!invalid)
+	{
+		mWidth = (int)value[1];
+		mHeight = (int)value[2];
+		mLevel = (int)value[3];
+		mFlags = (int)value[4];
+	}
+	else
+		mPosition = mData.length();				// Nothing to play
+
+	return invalid;
+}
+
+//***************************************************************************************
+//
+//	Function:	next
+//	Purpose:	Reads the next record: an input event code, or REPLAY_EVENT_LIST
+//				with the tetrad types available from list()
+//	Return:		True if replay has ended
+//
+//***************************************************************************************
+inline bool cReplayReader::next(int &event, unsigned long long &time)
+{
+	unsigned long long value;
+
+	if(mPosition >= mData.length())
+		return true;
+
+	if(varint(value))
+	{
+		mCorrupt = true;
+		return true;
+	}
+
+	mTime += value >> 3;
+	time = mTime;
+	event = (int)(value & 7);
+
+	if(event == 0)
+	{
+		int control = (mPosition < mData.length()) ? (unsigned char)mData[mPosition++] : -1;
+
+		if(control == REPLAY_NEXT && mPosition + 7 <= mData.length())
+		{
+			for(int i(0); i < 7; i++)
+				mList[i] = (unsigned char)mData[mPosition++];
+
+			event = REPLAY_EVENT_LIST;
+		}
+		else
+		{
+			mCorrupt = (control != REPLAY_END);
+			mPosition = mData.length();
+			return true;
+		}
+	}
+
+	return false;
+}
+
+//***************************************************************************************
+//
+//	Function:	varint
+//	Purpose:	Reads a varint written by cReplayWriter
+//	Return:		True if data ends inside the value or it is too long
+//
+//***************************************************************************************
+inline bool cReplayReader::varint(unsigned long long &value)
+{
+	unsigned char byte;
+	int shift(0);
+
+	value = 0;
+
+	do
+	{
+		if(mPosition >= mData.length() || shift > 63)
+			return true;
+
+		byte = (unsigned char)mData[mPosition++];
+		value |= (unsigned long long)(byte & 0x7F) << shift;
+		shift += 7;
+	}
+	while(byte & 0x80);
+
+	return false;
+}
+
+//***************************************************************************************
+//
+//	Function:	prepare
+//	Purpose:	Resets board to the recorded settings and starts the game
+//
+//***************************************************************************************
+inline void cReplayReader::prepare(cTrisEngine &board)
+{
+	board = cTrisEngine(mWidth, mHeight, (mFlags & REPLAY_PERMUTE) != 0, mLevel);
+	board.setAutonomy(!(mFlags & REPLAY_SERVER));
+	board.setSeed(mSeed);
+	board.start();
+}
+
+//***************************************************************************************
+//
+//	Function:	play
+//	Purpose:	Applies every remaining record to the board, ignoring timing
+//	Return:		Number of input events applied
+//
+//***************************************************************************************
+inline int cReplayReader::play(cTrisEngine &board)
+{
+	unsigned long long time;
+	int event;
+	int count(0);
+
+	while(!next(event, time))
+	{
+		if(event == REPLAY_EVENT_LIST)
+			board.setNext(mList);
+		else
+		{
+			execute(board, event);
+			count++;
+		}
+	}
+
+	return count;
+}
+
+//***************************************************************************************
+//
+//	Function:	execute
+//	Purpose:	Applies one input event to a board, as the game loop does
+//	Return:		Result of the engine call; positive if a tetrad locked
+//
+//***************************************************************************************
+inline int cReplayReader::execute(cTrisEngine &board, int event)
+{
+	int cleared;
+	int result(0);
+
+	switch(event)
+	{
+	case I_LEFT:
+		result = board.moveLeft();
+		break;
+
+	case I_RIGHT:
+		result = board.moveRight();
+		break;
+
+	case I_DOWN:
+		result = board.moveDown(cleared);
+		break;
+
+	case I_SONIC_LOCK:
+		result = board.sonicLock(cleared);
+		break;
+
+	case I_ROTATE_LEFT:
+		result = board.rotateLeft();
+		break;
+
+	case I_ROTATE_RIGHT:
+		result = board.rotateRight();
+		break;
+
+	case I_GRAVITY:
+		result = board.forceDown(cleared);
+		break;
+	};
+
+	return result;
+}
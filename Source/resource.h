@@ -27,7 +27,7 @@ using std::string;
 //	Purpose:	Returns time interval of tetrad drop for playing board's level
 //
 //***************************************************************************************
-long BTDropInterval(const unsigned int level)
+inline long BTDropInterval(const unsigned int level)
 {
 	return (2.2 - pow(level, 1/4.5)) * 1000;
 }
@@ -39,7 +39,7 @@ long BTDropInterval(const unsigned int level)
 //	Return:		Checksum value
 //
 //***************************************************************************************
-int BTChecksum(string name, long double score)
+inline int BTChecksum(string name, long double score)
 {
 	int checksum(0);
 	int upperScore = score / 100000;
@@ -70,6 +70,41 @@ int BTChecksum(string name, long double score)
 	return checksum;
 }
 
+//***************************************************************************************
+//
+//	Function:	BTCrc32
+//	Purpose:	Calculates the CRC-32 (IEEE 802.3, reflected) of a byte range.
+//				Seals stored score records.
+//	Return:		CRC
+//
+//***************************************************************************************
+inline unsigned int BTCrc32(const unsigned char* data, int length)
+{
+	struct cTable
+	{
+		cTable()
+		{
+			for(unsigned int n(0); n < 256; n++)
+			{
+				unsigned int c = n;
+				for(int k(0); k < 8; k++)
+					c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+				mEntries[n] = c;
+			}
+		}
+
+		unsigned int mEntries[256];
+	};
+	static const cTable table;					// Built once, on first use
+
+	unsigned int c = 0xFFFFFFFFu;
+
+	for(int i(0); i < length; i++)
+		c = table.mEntries[(c ^ data[i]) & 0xFF] ^ (c >> 8);
+
+	return c ^ 0xFFFFFFFFu;
+}
+
 //-------------------------------------------------------------------------------------O
 //
 //	Global Defines
@@ -212,6 +247,8 @@ int BTChecksum(string name, long double score)
 #define M_HIGH_SCORE_SUBMIT	33
 #define M_HIGH_SCORE_ACHIEVED 34
 #define M_NO_HIGH_SCORE		35
+#define M_REQUEST_RANK		36
+#define M_RANK_LIST			37
 
 #define M_SCORE_LIST_FAILURE 1
 #define M_SCORE_LIST_SUCCESS 2
@@ -239,6 +276,17 @@ int BTChecksum(string name, long double score)
 #define M_REQUEST_FIX		6
 #define M_GAME_END			7
 #define M_TETRAD			8
+#define M_INPUT				9
+
+// Input Events: carried by M_INPUT as event code, then frame number (high, low byte)
+#define I_LEFT				1
+#define I_RIGHT				2
+#define I_DOWN				3
+#define I_SONIC_LOCK		4
+#define I_ROTATE_LEFT		5
+#define I_ROTATE_RIGHT		6
+#define I_GRAVITY			7
+#define INPUT_EVENTSIZE		3
 
 // Message Codes: Client
 #define C_GLOBAL			7
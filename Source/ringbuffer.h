@@ -0,0 +1,613 @@
+//***************************************************************************************
+//
+//	Date Created:	October 17, 2026
+//	File:			ringbuffer.h
+//	Project:		Blue Tetris
+//
+//	Purpose:		Bounded lock-free message queues for passing messages between
+//					threads: cSPSCRing for one producer and one consumer, cMPSCRing
+//					for many producers and one consumer. Both use fixed storage
+//					allocated once. Waiting on an empty or full ring spins briefly,
+//					then sleeps until the other side signals it.
+//
+//***************************************************************************************
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <stddef.h>
+
+#define RING_SPINS			64			// Attempts before a waiting thread sleeps
+#define RING_PADDING		64			// Cache line size; keeps indices apart
+
+//***************************************************************************************
+//
+//	Class:		cRingWaiter
+//	Purpose:	Lets a thread sleep until a ring changes. The signalling side pays
+//				only an atomic load unless a thread is actually asleep.
+//
+//***************************************************************************************
+class cRingWaiter
+{
+public:
+	cRingWaiter(): mSleepers(0), mGeneration(0) {}
+
+	unsigned int prepare();						// Registers intent to sleep
+	void sleep(unsigned int observed);			// Sleeps until notified; after prepare()
+	void sleepFor(unsigned int observed, int milliseconds);	// Same, giving up after a time
+	void cancel();								// Withdraws prepare() without sleeping
+	void notify();								// Wakes sleepers, if any
+
+private:
+
+	std::atomic<int> mSleepers;					// Threads registered to sleep
+	std::mutex mLock;							// Pairs with mSignal
+	std::condition_variable mSignal;			// Signalled by notify()
+	unsigned int mGeneration;					// Notification count, guarded by mLock
+};
+
+//***************************************************************************************
+//
+//	Class:		cSPSCRing
+//	Purpose:	Bounded queue for exactly one producer thread and one consumer
+//				thread. Consumer functions mirror std::queue.
+//
+//***************************************************************************************
+template <class T>
+class cSPSCRing
+{
+public:
+	cSPSCRing(size_t capacity);					// Capacity is rounded up to a power of 2
+	~cSPSCRing() { delete[] mCells; }
+
+	// Producer
+	bool tryPush(const T &value);				// Returns true if ring is full
+	void push(const T &value);					// Waits while ring is full
+
+	// Consumer
+	bool tryPop(T &value);						// Returns true if ring is empty
+	void waitPop(T &value);						// Waits while ring is empty
+	bool waitPop(T &value, int milliseconds);	// Same, for at most a time
+	bool empty();
+	size_t size();
+	T &front();									// Oldest message; ring must not be empty
+	void pop();									// Discards oldest message
+
+	void clear();								// Only while no other thread uses ring
+
+private:
+
+	cSPSCRing(const cSPSCRing &);				// Not copyable
+	cSPSCRing &operator=(const cSPSCRing &);
+
+	T* mCells;									// Message storage
+	size_t mMask;								// Capacity - 1
+
+	char mPadHead[RING_PADDING];				// Keeps mHead off the other members' line
+	std::atomic<size_t> mHead;					// Next cell to read (consumer)
+	char mPadTail[RING_PADDING];				// Keeps mTail off mHead's line
+	std::atomic<size_t> mTail;					// Next cell to write (producer)
+	char mPadEnd[RING_PADDING];
+
+	cRingWaiter mNotEmpty;						// Consumer waits here
+	cRingWaiter mNotFull;						// Producer waits here
+};
+
+//***************************************************************************************
+//
+//	Class:		cMPSCRing
+//	Purpose:	Bounded queue for any number of producer threads and one consumer
+//				thread. Each cell carries a sequence number that tells producers
+//				and the consumer whose turn it is.
+//
+//***************************************************************************************
+template <class T>
+class cMPSCRing
+{
+public:
+	cMPSCRing(size_t capacity);					// Capacity is rounded up to a power of 2
+	~cMPSCRing() { delete[] mCells; delete[] mSequence; }
+
+	// Producers
+	bool tryPush(const T &value);				// Returns true if ring is full
+	void push(const T &value);					// Waits while ring is full
+
+	// Consumer
+	bool tryPop(T &value);						// Returns true if ring is empty
+	void waitPop(T &value);						// Waits while ring is empty
+	bool empty();
+
+	void clear();								// Only while no other thread uses ring
+
+private:
+
+	cMPSCRing(const cMPSCRing &);				// Not copyable
+	cMPSCRing &operator=(const cMPSCRing &);
+
+	T* mCells;									// Message storage
+	std::atomic<size_t>* mSequence;				// Turn marker of each cell
+	size_t mMask;								// Capacity - 1
+
+	char mPadHead[RING_PADDING];				// Keeps mHead off the other members' line
+	size_t mHead;								// Next cell to read (consumer only)
+	char mPadTail[RING_PADDING];				// Keeps mTail off mHead's line
+	std::atomic<size_t> mTail;					// Next cell to claim (producers)
+	char mPadEnd[RING_PADDING];
+
+	cRingWaiter mNotEmpty;						// Consumer waits here
+	cRingWaiter mNotFull;						// Producers wait here
+};
+
+//-------------------------------------------------------------------------------------O
+//
+//	cRingWaiter
+//
+
+//***************************************************************************************
+//
+//	Function:	prepare
+//	Purpose:	Announces that the caller is about to sleep. The caller must check
+//				the ring again afterwards, then call sleep() or cancel().
+//	Return:		Generation to pass to sleep(); each waiting thread keeps its own
+//
+//***************************************************************************************
+inline unsigned int cRingWaiter::prepare()
+{
+	std::lock_guard<std::mutex> guard(mLock);
+	unsigned int observed = mGeneration;
+
+	mSleepers.fetch_add(1);
+	std::atomic_thread_fence(std::memory_order_seq_cst);	// Before the caller's re-check
+
+	return observed;
+}
+
+//***************************************************************************************
+//
+//	Function:	sleep
+//	Purpose:	Sleeps until notify() is called after the matching prepare()
+//
+//***************************************************************************************
+inline void cRingWaiter::sleep(unsigned int observed)
+{
+	std::unique_lock<std::mutex> guard(mLock);
+
+	while(mGeneration == observed)
+		mSignal.wait(guard);
+
+	mSleepers.fetch_sub(1);
+}
+
+//***************************************************************************************
+//
+//	Function:	sleepFor
+//	Purpose:	Sleeps until notify() is called after the matching prepare(), or
+//				until the given time has passed
+//
+//***************************************************************************************
+inline void cRingWaiter::sleepFor(unsigned int observed, int milliseconds)
+{
+	std::unique_lock<std::mutex> guard(mLock);
+	std::chrono::steady_clock::time_point limit =
+		std::chrono::steady_clock::now() + std::chrono::milliseconds(milliseconds);
+
+	while(mGeneration == observed)
+		if(mSignal.wait_until(guard, limit) == std::cv_status::timeout)
+			break;
+
+	mSleepers.fetch_sub(1);
+}
+
+//***************************************************************************************
+//
+//	Function:	cancel
+//	Purpose:	Withdraws a prepare() when the re-check found the ring ready
+//
+//***************************************************************************************
+inline void cRingWaiter::cancel()
+{
+	mSleepers.fetch_sub(1);
+}
+
+//***************************************************************************************
+//
+//	Function:	notify
+//	Purpose:	Wakes sleeping threads. The fence orders the caller's ring update
+//				before the check for sleepers, pairing with prepare().
+//
+//***************************************************************************************
+inline void cRingWaiter::notify()
+{
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	if(mSleepers.load(std::memory_order_relaxed) > 0)
+	{
+		std::lock_guard<std::mutex> guard(mLock);
+		mGeneration++;
+		mSignal.notify_all();
+	}
+}
+
+//-------------------------------------------------------------------------------------O
+//
+//	cSPSCRing
+//
+
+//***************************************************************************************
+//
+//	Function:	constructor
+//	Purpose:	Allocates storage for at least the given number of messages
+//
+//***************************************************************************************
+template <class T>
+cSPSCRing<T>::cSPSCRing(size_t capacity): mHead(0), mTail(0)
+{
+	size_t size(2);
+
+	while(size < capacity)
+		size *= 2;
+
+	mCells = new T[size];
+	mMask = size - 1;
+}
+
+//***************************************************************************************
+//
+//	Function:	tryPush
+//	Purpose:	Appends message if there is room
+//	Return:		True if ring is full
+//
+//***************************************************************************************
+template <class T>
+bool cSPSCRing<T>::tryPush(const T &value)
+{
+	size_t tail = mTail.load(std::memory_order_relaxed);
+
+	if(tail - mHead.load(std::memory_order_acquire) > mMask)
+		return true;
+
+	mCells[tail & mMask] = value;
+	mTail.store(tail + 1, std::memory_order_release);
+	mNotEmpty.notify();
+
+	return false;
+}
+
+//***************************************************************************************
+//
+//	Function:	push
+//	Purpose:	Appends message, waiting for the consumer while the ring is full
+//
+//***************************************************************************************
+template <class T>
+void cSPSCRing<T>::push(const T &value)
+{
+	int spins(0);
+
+	while(tryPush(value))
+	{
+		if(spins++ < RING_SPINS)
+			std::this_thread::yield();
+		else
+		{
+			unsigned int observed = mNotFull.prepare();
+
+			if(mTail.load(std::memory_order_relaxed) - mHead.load(std::memory_order_acquire) > mMask)
+				mNotFull.sleep(observed);
+			else
+				mNotFull.cancel();
+		}
+	}
+}
+
+//***************************************************************************************
+//
+//	Function:	tryPop
+//	Purpose:	Removes oldest message
+//	Return:		True if ring is empty
+//
+//***************************************************************************************
+template <class T>
+bool cSPSCRing<T>::tryPop(T &value)
+{
+	if(empty())
+		return true;
+
+	value = front();
+	pop();
+
+	return false;
+}
+
+//***************************************************************************************
+//
+//	Function:	waitPop
+//	Purpose:	Removes oldest message, sleeping while the ring is empty
+//
+//***************************************************************************************
+template <class T>
+void cSPSCRing<T>::waitPop(T &value)
+{
+	int spins(0);
+
+	while(tryPop(value))
+	{
+		if(spins++ < RING_SPINS)
+			std::this_thread::yield();
+		else
+		{
+			unsigned int observed = mNotEmpty.prepare();
+
+			if(empty())
+				mNotEmpty.sleep(observed);
+			else
+				mNotEmpty.cancel();
+		}
+	}
+}
+
+//***************************************************************************************
+//
+//	Function:	waitPop (timed)
+//	Purpose:	Removes oldest message, sleeping at most the given time while the
+//				ring is empty
+//	Return:		True if ring is still empty
+//
+//***************************************************************************************
+template <class T>
+bool cSPSCRing<T>::waitPop(T &value, int milliseconds)
+{
+	if(!tryPop(value))
+		return false;
+
+	unsigned int observed = mNotEmpty.prepare();
+
+	if(empty())
+		mNotEmpty.sleepFor(observed, milliseconds);
+	else
+		mNotEmpty.cancel();
+
+	return tryPop(value);
+}
+
+//***************************************************************************************
+//
+//	Function:	empty
+//	Purpose:	Checks for pending messages
+//	Return:		True if ring is empty
+//
+//***************************************************************************************
+template <class T>
+bool cSPSCRing<T>::empty()
+{
+	return mHead.load(std::memory_order_relaxed) == mTail.load(std::memory_order_acquire);
+}
+
+//***************************************************************************************
+//
+//	Function:	size
+//	Purpose:	Counts pending messages
+//	Return:		Number of messages in ring
+//
+//***************************************************************************************
+template <class T>
+size_t cSPSCRing<T>::size()
+{
+	return mTail.load(std::memory_order_acquire) - mHead.load(std::memory_order_relaxed);
+}
+
+//***************************************************************************************
+//
+//	Function:	front
+//	Purpose:	Accesses oldest message without removing it
+//	Return:		Oldest message
+//
+//***************************************************************************************
+template <class T>
+T &cSPSCRing<T>::front()
+{
+	return mCells[mHead.load(std::memory_order_relaxed) & mMask];
+}
+
+//***************************************************************************************
+//
+//	Function:	pop
+//	Purpose:	Releases oldest message's cell to the producer
+//
+//***************************************************************************************
+template <class T>
+void cSPSCRing<T>::pop()
+{
+	size_t head = mHead.load(std::memory_order_relaxed);
+
+	mCells[head & mMask] = T();					// Release message's resources
+	mHead.store(head + 1, std::memory_order_release);
+	mNotFull.notify();
+}
+
+//***************************************************************************************
+//
+//	Function:	clear
+//	Purpose:	Discards all messages
+//
+//***************************************************************************************
+template <class T>
+void cSPSCRing<T>::clear()
+{
+	while(!empty())
+		pop();
+}
+
+//-------------------------------------------------------------------------------------O
+//
+//	cMPSCRing
+//
+
+//***************************************************************************************
+//
+//	Function:	constructor
+//	Purpose:	Allocates storage for at least the given number of messages
+//
+//***************************************************************************************
+template <class T>
+cMPSCRing<T>::cMPSCRing(size_t capacity): mHead(0), mTail(0)
+{
+	size_t size(2);
+
+	while(size < capacity)
+		size *= 2;
+
+	mCells = new T[size];
+	mSequence = new std::atomic<size_t>[size];
+	mMask = size - 1;
+
+	for(size_t i(0); i < size; i++)
+		mSequence[i].store(i, std::memory_order_relaxed);
+}
+
+//***************************************************************************************
+//
+//	Function:	tryPush
+//	Purpose:	Claims the next cell and appends message if there is room.
+//				A cell is free for position p when its sequence equals p.
+//	Return:		True if ring is full
+//
+//***************************************************************************************
+template <class T>
+bool cMPSCRing<T>::tryPush(const T &value)
+{
+	size_t tail = mTail.load(std::memory_order_relaxed);
+	size_t sequence;
+
+	while(true)
+	{
+		sequence = mSequence[tail & mMask].load(std::memory_order_acquire);
+
+		if(sequence == tail)					// Free: try to claim it
+		{
+			if(mTail.compare_exchange_weak(tail, tail + 1, std::memory_order_relaxed))
+				break;
+		}
+		else if(sequence < tail)				// Still holds a message one lap behind
+			return true;
+		else									// Claimed by another producer
+			tail = mTail.load(std::memory_order_relaxed);
+	}
+
+	mCells[tail & mMask] = value;
+	mSequence[tail & mMask].store(tail + 1, std::memory_order_release);
+	mNotEmpty.notify();
+
+	return false;
+}
+
+//***************************************************************************************
+//
+//	Function:	push
+//	Purpose:	Appends message, waiting for the consumer while the ring is full
+//
+//***************************************************************************************
+template <class T>
+void cMPSCRing<T>::push(const T &value)
+{
+	int spins(0);
+
+	while(tryPush(value))
+	{
+		if(spins++ < RING_SPINS)
+			std::this_thread::yield();
+		else
+		{
+			size_t tail = mTail.load(std::memory_order_relaxed);
+			unsigned int observed = mNotFull.prepare();
+
+			if(mSequence[tail & mMask].load(std::memory_order_acquire) < tail)
+				mNotFull.sleep(observed);
+			else
+				mNotFull.cancel();
+		}
+	}
+}
+
+//***************************************************************************************
+//
+//	Function:	tryPop
+//	Purpose:	Removes oldest message once its producer has finished writing it
+//	Return:		True if ring is empty
+//
+//***************************************************************************************
+template <class T>
+bool cMPSCRing<T>::tryPop(T &value)
+{
+	size_t cell = mHead & mMask;
+
+	if(mSequence[cell].load(std::memory_order_acquire) != mHead + 1)
+		return true;
+
+	value = mCells[cell];
+	mCells[cell] = T();							// Release message's resources
+	mSequence[cell].store(mHead + mMask + 1, std::memory_order_release);
+	mHead++;
+	mNotFull.notify();
+
+	return false;
+}
+
+//***************************************************************************************
+//
+//	Function:	waitPop
+//	Purpose:	Removes oldest message, sleeping while the ring is empty
+//
+//***************************************************************************************
+template <class T>
+void cMPSCRing<T>::waitPop(T &value)
+{
+	int spins(0);
+
+	while(tryPop(value))
+	{
+		if(spins++ < RING_SPINS)
+			std::this_thread::yield();
+		else
+		{
+			unsigned int observed = mNotEmpty.prepare();
+
+			if(empty())
+				mNotEmpty.sleep(observed);
+			else
+				mNotEmpty.cancel();
+		}
+	}
+}
+
+//***************************************************************************************
+//
+//	Function:	empty
+//	Purpose:	Checks whether the oldest message is ready to read
+//	Return:		True if no message is ready
+//
+//***************************************************************************************
+template <class T>
+bool cMPSCRing<T>::empty()
+{
+	return mSequence[mHead & mMask].load(std::memory_order_acquire) != mHead + 1;
+}
+
+//***************************************************************************************
+//
+//	Function:	clear
+//	Purpose:	Discards all messages
+//
+//***************************************************************************************
+template <class T>
+void cMPSCRing<T>::clear()
+{
+	T value;
+
+	while(!tryPop(value))
+	{}
+}
@@ -0,0 +1,387 @@
+//***************************************************************************************
+//
+//	Date Created:	October 17, 2026
+//	File:			scorefile.h
+//	Project:		Blue Tetris
+//
+//	Purpose:		Local high score file of the game client. The file is a fixed
+//					binary table mapped into memory: entries are read where they lie
+//					and a new score is written into its entry in place. Each entry
+//					holds a fixed-width name, a 64-bit score and a CRC-32 of both;
+//					an entry failing its CRC reads as empty. Values are stored in
+//					the byte order of the machine. A new table is built beside the
+//					file and renamed over it, so the old file stays whole until the
+//					new one is complete.
+//
+//***************************************************************************************
+
+#pragma once
+
+#include <string>
+#include <string.h>
+#include <stdio.h>
+#include "resource.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+using std::string;
+
+#define SCOREFILE_MAGIC		"BTSCORES"		// Leads the table
+#define SCOREFILE_VERSION	1
+#define SCOREFILE_ENTRIES	10				// Entries in the table
+#define SCOREFILE_NAMESIZE	16				// Name bytes in an entry, zero padded
+#define SCOREFILE_TEMPORARY	".tmp"			// Suffix of a table being built
+
+//***************************************************************************************
+//
+//	Class:		cScoreEntry
+//	Purpose:	One entry of the table, exactly as stored
+//
+//***************************************************************************************
+struct cScoreEntry
+{
+	char mName[SCOREFILE_NAMESIZE];
+	long long mScore;
+	unsigned int mReserved;						// Zero
+	unsigned int mChecksum;						// CRC-32 of the fields above
+};
+
+//***************************************************************************************
+//
+//	Class:		cScoreTable
+//	Purpose:	Layout of the whole file
+//
+//***************************************************************************************
+struct cScoreTable
+{
+	char mMagic[8];
+	unsigned int mVersion;
+	unsigned int mCount;						// SCOREFILE_ENTRIES
+	cScoreEntry mEntries[SCOREFILE_ENTRIES];
+};
+
+static_assert(sizeof(cScoreEntry) == 32, "score entries are 32 bytes on disk");
+static_assert(sizeof(cScoreTable) == 16 + 32 * SCOREFILE_ENTRIES, "score table has no padding");
+
+//***************************************************************************************
+//
+//	Class:		cScoreFile
+//	Purpose:	Mapping of a score table file
+//
+//***************************************************************************************
+class cScoreFile
+{
+public:
+	cScoreFile(): mTable(NULL)
+#ifdef _WIN32
+		, mFile(INVALID_HANDLE_VALUE), mMapping(NULL)
+#else
+		, mFile(-1)
+#endif
+		{}
+	~cScoreFile() { close(); }
+
+	bool open(const char* path);				// Maps existing table
+	bool create(const char* path);				// Makes and maps an empty table aside
+	bool commit();								// Moves created table over its path
+	void close();
+
+	static bool marked(const char* path);		// True if file starts as a table
+
+	bool read(int i, string &name, long double &score);		// Reads entry in place
+	void write(int i, const string &name, long double score);	// Writes entry in place
+	void flush();								// Starts writing changes to disk
+
+	bool mapped() { return mTable != NULL; }
+
+private:
+
+	cScoreFile(const cScoreFile&);				// Not copyable
+	cScoreFile& operator=(const cScoreFile&);
+
+	bool map(const char* path, bool reset);		// Opens, sizes and maps file
+	static unsigned int checksum(const cScoreEntry &entry);
+
+	cScoreTable* mTable;						// Mapped file; NULL if none
+	string mTarget;								// Path a created table is moved to
+#ifdef _WIN32
+	HANDLE mFile;
+	HANDLE mMapping;
+#else
+	int mFile;
+#endif
+};
+
+//***************************************************************************************
+//
+//	Function:	open
+//	Purpose:	Maps a score table. Leaves anything else, such as a score file
+//				from an earlier version, untouched.
+//	Return:		True if file is missing or is not a score table
+//
+//***************************************************************************************
+inline bool cScoreFile::open(const char* path)
+{
+	return map(path, false);
+}
+
+//***************************************************************************************
+//
+//	Function:	create
+//	Purpose:	Lays out an empty score table beside path and maps it. The file
+//				at path is left alone until commit().
+//	Return:		True if error occurs
+//
+//***************************************************************************************
+inline bool cScoreFile::create(const char* path)
+{
+	string temporary = string(path) + SCOREFILE_TEMPORARY;
+
+	if(map(temporary.c_str(), true))
+		return true;
+
+	mTarget = path;
+	return false;
+}
+
+//***************************************************************************************
+//
+//	Function:	commit
+//	Purpose:	Writes a created table to disk, renames it over its path and maps
+//				it there
+//	Return:		True if error occurs; the file at path is then unchanged
+//
+//***************************************************************************************
+inline bool cScoreFile::commit()
+{
+	string target = mTarget;
+	string temporary = target + SCOREFILE_TEMPORARY;
+	bool error;
+
+	if(!mTable || target.empty())
+		return true;
+
+#ifdef _WIN32
+	error = !FlushViewOfFile(mTable, 0) || !FlushFileBuffers(mFile);
+	close();
+	error = error || !MoveFileExA(temporary.c_str(), target.c_str(),
+		MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+#else
+	error = msync(mTable, sizeof(cScoreTable), MS_SYNC) != 0 || fsync(mFile) != 0;
+	close();
+	error = error || rename(temporary.c_str(), target.c_str()) != 0;
+#endif
+
+	return error || open(target.c_str());
+}
+
+//***************************************************************************************
+//
+//	Function:	marked
+//	Purpose:	Checks whether a file begins with SCOREFILE_MAGIC, so a damaged
+//				table can be told from a score file of an earlier version
+//	Return:		True if it does
+//
+//***************************************************************************************
+inline bool cScoreFile::marked(const char* path)
+{
+	char magic[sizeof(SCOREFILE_MAGIC) - 1];
+	FILE* file = fopen(path, "rb");
+	bool found(false);
+
+	if(file)
+	{
+		found = fread(magic, 1, sizeof(magic), file) == sizeof(magic) &&
+			memcmp(magic, SCOREFILE_MAGIC, sizeof(magic)) == 0;
+		fclose(file);
+	}
+
+	return found;
+}
+
+//***************************************************************************************
+//
+//	Function:	read
+//	Purpose:	Reads an entry straight from the mapping
+//	Return:		True if the entry is empty or fails its checksum
+//
+//***************************************************************************************
+inline bool cScoreFile::read(int i, string &name, long double &score)
+{
+	if(!mTable || i < 0 || i >= SCOREFILE_ENTRIES)
+		return true;
+
+	const cScoreEntry &entry = mTable->mEntries[i];
+
+	if(entry.mChecksum != checksum(entry) || entry.mName[0] == '\0')
+		return true;
+
+	name.assign(entry.mName, strnlen(entry.mName, SCOREFILE_NAMESIZE));
+	score = (long double)entry.mScore;
+
+	return false;
+}
+
+//***************************************************************************************
+//
+//	Function:	write
+//	Purpose:	Writes an entry into the mapping; an empty name clears it
+//
+//***************************************************************************************
+inline void cScoreFile::write(int i, const string &name, long double score)
+{
+	if(!mTable || i < 0 || i >= SCOREFILE_ENTRIES)
+		return;
+
+	cScoreEntry &entry = mTable->mEntries[i];
+	size_t length = name.length() < SCOREFILE_NAMESIZE ? name.length() : SCOREFILE_NAMESIZE;
+
+	memset(&entry, 0, sizeof(entry));
+	memcpy(entry.mName, name.c_str(), length);
+	entry.mScore = score > 0 ? (long long)score : 0;
+	entry.mChecksum = checksum(entry);
+}
+
+//***************************************************************************************
+//
+//	Function:	flush
+//	Purpose:	Schedules changed pages to be written to disk without waiting
+//
+//***************************************************************************************
+inline void cScoreFile::flush()
+{
+	if(!mTable)
+		return;
+
+#ifdef _WIN32
+	FlushViewOfFile(mTable, 0);
+#else
+	msync(mTable, sizeof(cScoreTable), MS_ASYNC);
+#endif
+}
+
+//***************************************************************************************
+//
+//	Function:	close
+//	Purpose:	Writes changes back and unmaps file
+//
+//***************************************************************************************
+inline void cScoreFile::close()
+{
+#ifdef _WIN32
+	if(mTable)
+		UnmapViewOfFile(mTable);
+	if(mMapping)
+		CloseHandle(mMapping);
+	if(mFile != INVALID_HANDLE_VALUE)
+		CloseHandle(mFile);
+
+	mMapping = NULL;
+	mFile = INVALID_HANDLE_VALUE;
+#else
+	if(mTable)
+		munmap(mTable, sizeof(cScoreTable));
+	if(mFile >= 0)
+		::close(mFile);
+
+	mFile = -1;
+#endif
+
+	mTable = NULL;
+	mTarget.clear();
+}
+
+//***************************************************************************************
+//
+//	Function:	map
+//	Purpose:	Opens file and maps the table. With reset, the file is created or
+//				emptied and a table with no entries is laid out; otherwise the file
+//				must already hold a table of this version.
+//	Return:		True if error occurs
+//
+//***************************************************************************************
+inline bool cScoreFile::map(const char* path, bool reset)
+{
+	close();
+
+#ifdef _WIN32
+	mFile = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL,
+		reset ? CREATE_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if(mFile == INVALID_HANDLE_VALUE)
+		return true;
+
+	LARGE_INTEGER size;
+	if(!reset && (!GetFileSizeEx(mFile, &size) || size.QuadPart != sizeof(cScoreTable)))
+	{
+		close();
+		return true;
+	}
+
+	mMapping = CreateFileMappingA(mFile, NULL, PAGE_READWRITE, 0, sizeof(cScoreTable), NULL);
+	if(mMapping)
+		mTable = (cScoreTable*)MapViewOfFile(mMapping, FILE_MAP_WRITE, 0, 0, sizeof(cScoreTable));
+#else
+	struct stat info;
+
+	mFile = ::open(path, reset ? O_RDWR | O_CREAT | O_TRUNC : O_RDWR, 0644);
+	if(mFile < 0)
+		return true;
+
+	if(reset ? ftruncate(mFile, sizeof(cScoreTable)) != 0 :
+		fstat(mFile, &info) != 0 || info.st_size != (off_t)sizeof(cScoreTable))
+	{
+		close();
+		return true;
+	}
+
+	void* view = mmap(NULL, sizeof(cScoreTable), PROT_READ | PROT_WRITE, MAP_SHARED, mFile, 0);
+	if(view != MAP_FAILED)
+		mTable = (cScoreTable*)view;
+#endif
+
+	if(!mTable)
+	{
+		close();
+		return true;
+	}
+
+	if(reset)
+	{
+		memset(mTable, 0, sizeof(cScoreTable));
+		memcpy(mTable->mMagic, SCOREFILE_MAGIC, sizeof(mTable->mMagic));
+		mTable->mVersion = SCOREFILE_VERSION;
+		mTable->mCount = SCOREFILE_ENTRIES;
+
+		for(int i(0); i < SCOREFILE_ENTRIES; i++)
+			mTable->mEntries[i].mChecksum = checksum(mTable->mEntries[i]);
+
+		flush();
+	}
+	else if(memcmp(mTable->mMagic, SCOREFILE_MAGIC, sizeof(mTable->mMagic)) ||
+		mTable->mVersion != SCOREFILE_VERSION || mTable->mCount != SCOREFILE_ENTRIES)
+	{
+		close();
+		return true;
+	}
+
+	return false;
+}
+
+//***************************************************************************************
+//
+//	Function:	checksum
+//	Purpose:	Computes the CRC-32 of an entry's name, score and reserved word
+//	Return:		Checksum
+//
+//***************************************************************************************
+inline unsigned int cScoreFile::checksum(const cScoreEntry &entry)
+{
+	return BTCrc32((const unsigned char*)&entry, sizeof(entry) - sizeof(entry.mChecksum));
+}
@@ -0,0 +1,541 @@
+//***************************************************************************************
+//
+//	Date Created:	October 17, 2026
+//	File:			scorejournal.h
+//	Project:		Blue Tetris
+//
+//	Purpose:		Crash-safe score storage for the server's local data mode. Scores
+//					are appended to a journal of fixed-size records, each sealed with
+//					a CRC-32, and synced once per batch. Startup replays a snapshot
+//					and then the journal; a record torn by a crash fails its CRC and
+//					is cut off. Once the journal outgrows the snapshot, the two are
+//					compacted into a new snapshot, written aside and renamed over the
+//					old one, so a crash at any point leaves a complete copy.
+//
+//***************************************************************************************
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+#include <string.h>
+#include <stdio.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include "resource.h"
+#include "leaderboard.h"
+
+#ifdef _WIN32
+#include <io.h>
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+using std::string;
+using std::vector;
+using std::unordered_map;
+
+#define JOURNAL_FILE		"Data/serverscores.jnl"
+#define JOURNAL_SNAPSHOT	"Data/serverscores.snp"
+#define JOURNAL_MAGIC		"BTSCORE1"		// Leads both files
+#define JOURNAL_HEADER		8				// Bytes of magic
+#define JOURNAL_NAMESIZE	16				// Name bytes in a record, zero padded
+#define JOURNAL_RECORD		32				// Name, score, board, level, CRC
+#define JOURNAL_COMPACTMIN	1024			// Journal records before compaction pays
+
+//***************************************************************************************
+//
+//	Class:		cScoreJournal
+//	Purpose:	Journal and snapshot files of one score store. Not thread-safe;
+//				the server's score writer is its only user.
+//
+//***************************************************************************************
+class cScoreJournal
+{
+public:
+	cScoreJournal(const char* journal = JOURNAL_FILE, const char* snapshot = JOURNAL_SNAPSHOT):
+		mJournalPath(journal), mSnapshotPath(snapshot), mFile(-1), mEnd(0), mJournalCount(0),
+		mSnapshotCount(0) {}
+	~cScoreJournal() { close(); }
+
+	bool open(vector<cScoreRecord> &records);	// Replays files, opens journal
+	bool exists();								// True if snapshot or journal exists
+	bool append(const vector<cScoreRecord> &records);	// Appends and syncs batch
+	bool due();									// True if compaction is worthwhile
+	bool compact();								// Rewrites snapshot from both files
+	bool compact(const vector<cScoreRecord> &records);	// Makes records the snapshot
+	void close();
+
+private:
+
+	cScoreJournal(const cScoreJournal&);		// Not copyable
+	cScoreJournal& operator=(const cScoreJournal&);
+
+	bool openJournal(vector<cScoreRecord> &records);	// Replays and opens journal alone
+
+	static void encode(const cScoreRecord &record, unsigned char* out);
+	static bool decode(const unsigned char* in, cScoreRecord &record);
+	static long long replay(const char* path, vector<cScoreRecord> &records, long long &end);
+	static bool writeAll(int file, const unsigned char* data, size_t length);
+	static bool sync(int file);
+	static bool truncate(int file, long long length);	// Cuts file, seeks to its end
+	static bool sealFile(const string &path, const vector<cScoreRecord> &records);
+
+	string mJournalPath;
+	string mSnapshotPath;
+	int mFile;									// Journal, open for appending
+	long long mEnd;								// Journal length after last record
+	long long mJournalCount;					// Records in journal
+	long long mSnapshotCount;					// Records in snapshot
+};
+
+//***************************************************************************************
+//
+//	Function:	open
+//	Purpose:	Reads the snapshot, then the journal, into records in the order
+//				they were written. Cuts a torn record off the end of the journal
+//				and opens it for appending.
+//	Return:		True if error occurs
+//
+//***************************************************************************************
+inline bool cScoreJournal::open(vector<cScoreRecord> &records)
+{
+	long long end;
+
+	close();
+	records.clear();
+
+	mSnapshotCount = replay(mSnapshotPath.c_str(), records, end);
+
+	return openJournal(records);
+}
+
+//***************************************************************************************
+//
+//	Function:	openJournal
+//	Purpose:	Reads the journal into records, cuts a torn record off its end
+//				and opens it for appending
+//	Return:		True if error occurs
+//
+//***************************************************************************************
+inline bool cScoreJournal::openJournal(vector<cScoreRecord> &records)
+{
+	long long end;
+
+	mJournalCount = replay(mJournalPath.c_str(), records, end);
+
+#ifdef _WIN32
+	mFile = _open(mJournalPath.c_str(), _O_RDWR | _O_CREAT | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+	mFile = ::open(mJournalPath.c_str(), O_RDWR | O_CREAT, 0644);
+#endif
+	if(mFile < 0)
+		return true;
+
+	bool error(false);
+
+	if(end < JOURNAL_HEADER)					// New or torn header: start over
+	{
+		end = JOURNAL_HEADER;
+		error = truncate(mFile, 0) ||
+			writeAll(mFile, (const unsigned char*)JOURNAL_MAGIC, JOURNAL_HEADER);
+	}
+	else										// Drop anything after last good record
+		error = truncate(mFile, end);
+
+	error = error || sync(mFile);
+	mEnd = end;
+
+	if(error)
+		close();
+
+	return error;
+}
+
+//***************************************************************************************
+//
+//	Function:	exists
+//	Purpose:	Checks for a journal or snapshot on disk
+//	Return:		True if either exists
+//
+//***************************************************************************************
+inline bool cScoreJournal::exists()
+{
+	struct stat info;
+
+	return stat(mJournalPath.c_str(), &info) == 0 || stat(mSnapshotPath.c_str(), &info) == 0;
+}
+
+//***************************************************************************************
+//
+//	Function:	append
+//	Purpose:	Appends a batch of records in one write and syncs the journal's
+//				data once for the whole batch. A failed write is cut back off, so
+//				later batches stay aligned to whole records. A journal that could
+//				not be opened is opened again first; its records are already held.
+//	Return:		True if error occurs
+//***************************************************************************************
+inline bool cScoreJournal::append(const vector<cScoreRecord> &records)
+{
+	vector<cScoreRecord> held;
+
+	if(mFile < 0 && openJournal(held))
+		return true;
+	if(records.empty())
+		return false;
+
+	vector<unsigned char> buffer(records.size() * JOURNAL_RECORD);
+
+	for(unsigned int i(0); i < records.size(); i++)
+		encode(records[i], &buffer[i * JOURNAL_RECORD]);
+
+	if(writeAll(mFile, &buffer[0], buffer.size()) || sync(mFile))
+	{
+		truncate(mFile, mEnd);
+		return true;
+	}
+
+	mEnd += buffer.size();
+	mJournalCount += records.size();
+	return false;
+}
+
+//***************************************************************************************
+//
+//	Function:	due
+//	Purpose:	Checks whether the journal has grown past the snapshot
+//	Return:		True if compaction is due
+//
+//***************************************************************************************
+inline bool cScoreJournal::due()
+{
+	return mJournalCount >= JOURNAL_COMPACTMIN && mJournalCount >= mSnapshotCount;
+}
+
+//***************************************************************************************
+//
+//	Function:	compact
+//	Purpose:	Folds snapshot and journal into a new snapshot that keeps only the
+//				record of each player's best score on each board. The records
+//				are kept in the order they were written, so replaying the new
+//				snapshot ranks equal scores as before.
+//	Return:		True if error occurs; the old files are left as they were
+//
+//***************************************************************************************
+inline bool cScoreJournal::compact()
+{
+	vector<cScoreRecord> records;
+	vector<unsigned int> best;					// Index of each kept record
+	unordered_map<string, unsigned int> index;	// Player and board to kept record
+	long long end;
+	char key[64];
+
+	replay(mSnapshotPath.c_str(), records, end);
+	replay(mJournalPath.c_str(), records, end);
+
+	for(unsigned int i(0); i < records.size(); i++)
+	{
+		sprintf(key, "%d %d %d ", records[i].mWidth, records[i].mHeight, records[i].mLevel);
+
+		std::pair<unordered_map<string, unsigned int>::iterator, bool> entry =
+			index.insert(std::make_pair(key + records[i].mName, (unsigned int)best.size()));
+
+		if(entry.second)
+			best.push_back(i);
+		else if(records[i].mScore > records[best[entry.first->second]].mScore)
+			best[entry.first->second] = i;
+	}
+
+	std::sort(best.begin(), best.end());		// Back to written order
+
+	vector<cScoreRecord> kept;
+	kept.reserve(best.size());
+	for(unsigned int i(0); i < best.size(); i++)
+		kept.push_back(records[best[i]]);
+
+	return compact(kept);
+}
+
+//***************************************************************************************
+//
+//	Function:	compact
+//	Purpose:	Seals records as the new snapshot, then empties the journal. A
+//				crash between the two replays the journal over a snapshot that
+//				already holds it, which changes no leaderboard.
+//	Return:		True if error occurs
+//
+//***************************************************************************************
+inline bool cScoreJournal::compact(const vector<cScoreRecord> &records)
+{
+	if(sealFile(mSnapshotPath, records))
+		return true;
+
+	mSnapshotCount = records.size();
+
+	if(mFile < 0)
+		return false;
+
+	bool error = truncate(mFile, JOURNAL_HEADER) || sync(mFile);
+
+	if(!error)
+	{
+		mEnd = JOURNAL_HEADER;
+		mJournalCount = 0;
+	}
+
+	return error;
+}
+
+//***************************************************************************************
+//
+//	Function:	close
+//	Purpose:	Closes journal; every appended batch is already synced
+//
+//***************************************************************************************
+inline void cScoreJournal::close()
+{
+	if(mFile >= 0)
+#ifdef _WIN32
+		_close(mFile);
+#else
+		::close(mFile);
+#endif
+
+	mFile = -1;
+}
+
+//***************************************************************************************
+//
+//	Function:	encode
+//	Purpose:	Lays a record out in JOURNAL_RECORD bytes, little-endian: name,
+//				score as a 64-bit integer, width, height, 16-bit level, then the
+//				CRC of the preceding bytes
+//
+//***************************************************************************************
+inline void cScoreJournal::encode(const cScoreRecord &record, unsigned char* out)
+{
+	unsigned long long score = record.mScore > 0 ? (unsigned long long)record.mScore : 0;
+	int length = (int)record.mName.length();
+	int i;
+
+	memset(out, 0, JOURNAL_RECORD);
+	memcpy(out, record.mName.c_str(), length < JOURNAL_NAMESIZE ? length : JOURNAL_NAMESIZE);
+
+	for(i = 0; i < 8; i++)
+		out[JOURNAL_NAMESIZE + i] = (unsigned char)(score >> (8 * i));
+
+	out[24] = (unsigned char)record.mWidth;
+	out[25] = (unsigned char)record.mHeight;
+	out[26] = (unsigned char)record.mLevel;
+	out[27] = (unsigned char)(record.mLevel >> 8);
+
+	unsigned int sum = BTCrc32(out, 28);
+	for(i = 0; i < 4; i++)
+		out[28 + i] = (unsigned char)(sum >> (8 * i));
+}
+
+//***************************************************************************************
+//
+//	Function:	decode
+//	Purpose:	Reads a record laid out by encode
+//	Return:		True if its CRC does not match
+//
+//***************************************************************************************
+inline bool cScoreJournal::decode(const unsigned char* in, cScoreRecord &record)
+{
+	unsigned long long score(0);
+	unsigned int sum(0);
+	int i;
+
+	for(i = 0; i < 4; i++)
+		sum |= (unsigned int)in[28 + i] << (8 * i);
+
+	if(sum != BTCrc32(in, 28))
+		return true;
+
+	for(i = 0; i < 8; i++)
+		score |= (unsigned long long)in[JOURNAL_NAMESIZE + i] << (8 * i);
+
+	record.mName.assign((const char*)in, strnlen((const char*)in, JOURNAL_NAMESIZE));
+	record.mScore = (long double)score;
+	record.mWidth = in[24];
+	record.mHeight = in[25];
+	record.mLevel = in[26] | in[27] << 8;
+
+	return false;
+}
+
+//***************************************************************************************
+//
+//	Function:	replay
+//	Purpose:	Appends the valid records of a file to records. Records failing
+//				their CRC are skipped.
+//	Return:		Records read. end receives the offset after the last valid
+//				record, or 0 if the file is missing or its header is not intact.
+//
+//***************************************************************************************
+inline long long cScoreJournal::replay(const char* path, vector<cScoreRecord> &records,
+	long long &end)
+{
+	unsigned char buffer[JOURNAL_RECORD * 256];
+	cScoreRecord record;
+	long long count(0);
+	long long offset;
+	size_t read, used;
+	FILE* file = fopen(path, "rb");
+
+	end = 0;
+	if(!file)
+		return 0;
+
+	if(fread(buffer, 1, JOURNAL_HEADER, file) != JOURNAL_HEADER ||
+		memcmp(buffer, JOURNAL_MAGIC, JOURNAL_HEADER))
+	{
+		fclose(file);
+		return 0;
+	}
+
+	end = offset = JOURNAL_HEADER;
+
+	while((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+	{
+		for(used = 0; used + JOURNAL_RECORD <= read; used += JOURNAL_RECORD)
+		{
+			offset += JOURNAL_RECORD;
+
+			if(!decode(buffer + used, record))
+			{
+				records.push_back(record);
+				end = offset;
+				count++;
+			}
+		}
+
+		if(used < read)							// Partial record: torn write
+			break;
+	}
+
+	fclose(file);
+	return count;
+}
+
+//***************************************************************************************
+//
+//	Function:	writeAll
+//	Purpose:	Writes a whole buffer, resuming after short writes
+//	Return:		True if error occurs
+//
+//***************************************************************************************
+inline bool cScoreJournal::writeAll(int file, const unsigned char* data, size_t length)
+{
+	while(length > 0)
+	{
+#ifdef _WIN32
+		int written = _write(file, data, (unsigned int)length);
+#else
+		ssize_t written = write(file, data, length);
+#endif
+		if(written <= 0)
+			return true;
+
+		data += written;
+		length -= written;
+	}
+
+	return false;
+}
+
+//***************************************************************************************
+//
+//	Function:	sync
+//	Purpose:	Flushes a file's data to the disk. File times are not waited for
+//				where the system allows it.
+//	Return:		True if error occurs
+//
+//***************************************************************************************
+inline bool cScoreJournal::sync(int file)
+{
+#if defined(_WIN32)
+	return _commit(file) != 0;
+#elif defined(__linux__)
+	return fdatasync(file) != 0;
+#else
+	return fsync(file) != 0;
+#endif
+}
+
+//***************************************************************************************
+//
+//	Function:	truncate
+//	Purpose:	Sets a file's length and moves its position to the end
+//	Return:		True if error occurs
+//
+//***************************************************************************************
+inline bool cScoreJournal::truncate(int file, long long length)
+{
+#ifdef _WIN32
+	return _chsize(file, (long)length) != 0 || _lseek(file, (long)length, SEEK_SET) < 0;
+#else
+	return ftruncate(file, (off_t)length) != 0 || lseek(file, (off_t)length, SEEK_SET) < 0;
+#endif
+}
+
+//***************************************************************************************
+//
+//	Function:	sealFile
+//	Purpose:	Writes records to a file beside path, syncs it and renames it over
+//				path, so path always holds either the old or the new contents
+//	Return:		True if error occurs
+//
+//***************************************************************************************
+inline bool cScoreJournal::sealFile(const string &path, const vector<cScoreRecord> &records)
+{
+	string temporary = path + ".tmp";
+	vector<unsigned char> buffer(JOURNAL_HEADER + records.size() * JOURNAL_RECORD);
+	bool error;
+
+	memcpy(&buffer[0], JOURNAL_MAGIC, JOURNAL_HEADER);
+	for(unsigned int i(0); i < records.size(); i++)
+		encode(records[i], &buffer[JOURNAL_HEADER + i * JOURNAL_RECORD]);
+
+#ifdef _WIN32
+	int file = _open(temporary.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY,
+		_S_IREAD | _S_IWRITE);
+#else
+	int file = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+#endif
+	if(file < 0)
+		return true;
+
+	error = writeAll(file, &buffer[0], buffer.size()) || sync(file);
+
+#ifdef _WIN32
+	_close(file);
+	error = error || !MoveFileExA(temporary.c_str(), path.c_str(),
+		MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+#else
+	::close(file);
+	error = error || rename(temporary.c_str(), path.c_str()) != 0;
+
+	if(!error)									// Make the rename itself durable
+	{
+		size_t slash = path.rfind('/');
+		string folder = slash == string::npos ? string(".") : path.substr(0, slash);
+		int directory = ::open(folder.c_str(), O_RDONLY);
+
+		if(directory >= 0)
+		{
+			fsync(directory);
+			::close(directory);
+		}
+	}
+#endif
+
+	if(error)
+		remove(temporary.c_str());
+
+	return error;
+}
@@ -0,0 +1,354 @@
+//***************************************************************************************
+//
+//	Date Created:	October 17, 2026
+//	File:			selfplay.cpp
+//	Project:		Blue Tetris
+//
+//	Purpose:		Self-play harness for tuning bots. Plays batches of headless bot
+//					games for several heuristic weight sets in parallel on a
+//					work-stealing pool and reports average lines, score and survival
+//					for each set. Game n of every set uses the same seed, so sets
+//					are compared on the same tetrad sequences.
+//
+//					btselfplay [options]
+//						-n games		Games per weight set (default 100)
+//						-k sets			Weight sets drawn around the defaults (default 8)
+//						-f file			Read weight sets instead, four numbers a line:
+//										height lines holes bumpiness
+//						-t threads		Threads (default one per hardware thread)
+//						-d depth		Bot lookahead in tetrads (default 2)
+//						-b width		Beam search keeping width boards per depth,
+//										through the preview queue
+//						-m pieces		Piece limit per game (default 2000)
+//						-w width		Board width (default 10)
+//						-h height		Board height (default 22)
+//						-l level		Starting level (default 0)
+//						-x seed			Seed of first game and weight draws (default 1)
+//
+//***************************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include "bot.h"
+#include "random.h"
+#include "workpool.h"
+using std::vector;
+using std::atomic;
+
+#define SELFPLAY_GAMES		100			// Defaults
+#define SELFPLAY_SETS		8
+#define SELFPLAY_PIECES		2000
+#define SELFPLAY_SEED		1
+#define SELFPLAY_SPREAD		0.5			// Drawn weights vary this fraction either way
+
+//***************************************************************************************
+//
+//	Class:		cTally
+//	Purpose:	Totals of one weight set's games. Every game adds to the totals
+//				with atomic additions, so threads never wait on each other; each
+//				tally has its own cache lines.
+//
+//***************************************************************************************
+class cTally
+{
+public:
+	cTally(): mGames(0), mLines(0), mScore(0), mPieces(0), mTopOuts(0) {}
+
+	void add(long long lines, long long score, long long pieces, bool toppedOut);
+
+	atomic<long long> mGames;
+	atomic<long long> mLines;
+	atomic<long long> mScore;
+	atomic<long long> mPieces;					// Survival: pieces placed
+	atomic<long long> mTopOuts;					// Games that ended before the limit
+	char mPad[RING_PADDING];
+};
+
+//***************************************************************************************
+//
+//	Function:	add
+//	Purpose:	Adds one game's results
+//
+//***************************************************************************************
+void cTally::add(long long lines, long long score, long long pieces, bool toppedOut)
+{
+	mGames.fetch_add(1, std::memory_order_relaxed);
+	mLines.fetch_add(lines, std::memory_order_relaxed);
+	mScore.fetch_add(score, std::memory_order_relaxed);
+	mPieces.fetch_add(pieces, std::memory_order_relaxed);
+	if(toppedOut)
+		mTopOuts.fetch_add(1, std::memory_order_relaxed);
+}
+
+//***************************************************************************************
+//
+//	Class:		cSelfPlay
+//	Purpose:	One batch: weight sets, game settings and a tally per set. Task
+//				numbers from the pool select a game of a set; everything a game
+//				changes is local to the call.
+//
+//***************************************************************************************
+class cSelfPlay
+{
+public:
+	cSelfPlay(const vector<cBotWeights> &weights, int games): mWeights(weights),
+		mTallies(new cTally[weights.size()]), mGames(games), mDepth(BOT_LOOKAHEAD),
+		mBeam(0), mLimit(SELFPLAY_PIECES), mWidth(BOARDWIDTH), mHeight(BOARDDEPTH), mLevel(0),
+		mSeed(SELFPLAY_SEED) {}
+	~cSelfPlay() { delete[] mTallies; }
+
+	void operator()(int task, int thread);		// Plays one game
+	int tasks() { return (int)mWeights.size() * mGames; }
+	void report(double seconds);
+
+	vector<cBotWeights> mWeights;
+	cTally* mTallies;							// One per weight set
+	int mGames;									// Games per set
+	int mDepth;									// Bot lookahead
+	int mBeam;									// Beam width; 0 for full search
+	int mLimit;									// Pieces per game
+	int mWidth;
+	int mHeight;
+	int mLevel;
+	unsigned long long mSeed;					// Seed of game 0
+
+private:
+
+	cSelfPlay(const cSelfPlay&);				// Not copyable
+	cSelfPlay& operator=(const cSelfPlay&);
+};
+
+//***************************************************************************************
+//
+//	Function:	operator()
+//	Purpose:	Plays one game to game over or the piece limit. Bots place tetrads
+//				directly; timing and input paths do not change the outcome.
+//
+//***************************************************************************************
+void cSelfPlay::operator()(int task, int /*thread*/)
+{
+	int set = task % (int)mWeights.size();		// Neighbouring tasks spread over sets
+	int game = task / (int)mWeights.size();
+	cTrisEngine board(mWidth, mHeight, true, mLevel);
+	cBot bot;
+	int pieces(0);
+	int cleared;
+
+	bot.setWeights(mWeights[set]);
+	bot.setDepth(mDepth);
+	bot.setBeam(mBeam, mDepth);
+
+	board.setSeed(mSeed + game);
+	board.start();
+
+	while(pieces < mLimit && !board.gameOver())
+	{
+		if(bot.plan(board) || cMoveGenerator::lock(board, bot.target(), cleared))
+			break;
+		pieces++;
+	}
+
+	mTallies[set].add(board.singles() + 2 * board.doubles() + 3 * board.triples() +
+		4 * board.tetrises(), (long long)board.score(), pieces, board.gameOver());
+}
+
+//***************************************************************************************
+//
+//	Function:	report
+//	Purpose:	Prints averages for each weight set and batch throughput
+//
+//***************************************************************************************
+void cSelfPlay::report(double seconds)
+{
+	long long games(0);
+	long long pieces(0);
+
+	printf("|  set    height     lines     holes bumpiness |     lines      score  survival  topped\n");
+
+	for(unsigned int i(0); i < mWeights.size(); i++)
+	{
+		cTally &tally = mTallies[i];
+		double count = tally.mGames > 0 ? (double)tally.mGames : 1;
+
+		printf("| %4u %9.4f %9.4f %9.4f %9.4f | %9.1f %10.0f %9.1f %6.1f%%\n", i,
+			mWeights[i].mHeight, mWeights[i].mLines, mWeights[i].mHoles, mWeights[i].mBumpiness,
+			tally.mLines / count, tally.mScore / count, tally.mPieces / count,
+			100.0 * tally.mTopOuts / count);
+
+		games += tally.mGames;
+		pieces += tally.mPieces;
+	}
+
+	if(seconds <= 0)
+		seconds = 1e-9;
+
+	printf("\n| %lld games, %lld pieces in %.3f s: %.1f games/s, %.0f pieces/s\n",
+		games, pieces, seconds, games / seconds, pieces / seconds);
+}
+
+//***************************************************************************************
+//
+//	Function:	drawWeights
+//	Purpose:	Lists the default weights followed by sets drawn around them
+//
+//***************************************************************************************
+void drawWeights(vector<cBotWeights> &weights, int count, unsigned long long seed)
+{
+	cRandom random;
+	cBotWeights base;
+
+	random.seed(seed, RANDOM_DEFAULT_STREAM ^ 2);
+	weights.clear();
+	weights.push_back(base);
+
+	for(int i(1); i < count; i++)
+	{
+		double scale[4];
+		for(int k(0); k < 4; k++)
+			scale[k] = 1 + SELFPLAY_SPREAD * (2 * (random.next() / 4294967296.0) - 1);
+
+		weights.push_back(cBotWeights(base.mHeight * scale[0], base.mLines * scale[1],
+			base.mHoles * scale[2], base.mBumpiness * scale[3]));
+	}
+}
+
+//***************************************************************************************
+//
+//	Function:	readWeights
+//	Purpose:	Reads weight sets from a file, four numbers a line
+//	Return:		True if file cannot be read or holds no set
+//
+//***************************************************************************************
+bool readWeights(vector<cBotWeights> &weights, const char* path)
+{
+	FILE* file = fopen(path, "r");
+	cBotWeights set;
+
+	if(!file)
+		return true;
+
+	weights.clear();
+	while(fscanf(file, "%lf %lf %lf %lf", &set.mHeight, &set.mLines, &set.mHoles,
+		&set.mBumpiness) == 4)
+		weights.push_back(set);
+
+	fclose(file);
+	return weights.empty();
+}
+
+//***************************************************************************************
+//
+//	Function:	usage
+//	Purpose:	Prints command line help
+//
+//***************************************************************************************
+void usage()
+{
+	printf("usage: btselfplay [-n games] [-k sets | -f file] [-t threads] [-d depth]\n"
+		"                  [-b width] [-m pieces] [-w width] [-h height] [-l level] [-x seed]\n");
+}
+
+int main(int argc, char* argv[])
+{
+	int games(SELFPLAY_GAMES);
+	int sets(SELFPLAY_SETS);
+	int threads(0);
+	int depth(BOT_LOOKAHEAD);
+	int beam(0);
+	int limit(SELFPLAY_PIECES);
+	int width(BOARDWIDTH);
+	int height(BOARDDEPTH);
+	int level(0);
+	unsigned long long seed(SELFPLAY_SEED);
+	const char* weightFile = NULL;
+
+	for(int i(1); i < argc; i += 2)
+	{
+		if(i + 1 >= argc)
+		{
+			usage();
+			return 1;
+		}
+		else if(!strcmp(argv[i], "-n"))
+			games = atoi(argv[i + 1]);
+		else if(!strcmp(argv[i], "-k"))
+			sets = atoi(argv[i + 1]);
+		else if(!strcmp(argv[i], "-f"))
+			weightFile = argv[i + 1];
+		else if(!strcmp(argv[i], "-t"))
+			threads = atoi(argv[i + 1]);
+		else if(!strcmp(argv[i], "-d"))
+			depth = atoi(argv[i + 1]);
+		else if(!strcmp(argv[i], "-b"))
+			beam = atoi(argv[i + 1]);
+		else if(!strcmp(argv[i], "-m"))
+			limit = atoi(argv[i + 1]);
+		else if(!strcmp(argv[i], "-w"))
+			width = atoi(argv[i + 1]);
+		else if(!strcmp(argv[i], "-h"))
+			height = atoi(argv[i + 1]);
+		else if(!strcmp(argv[i], "-l"))
+			level = atoi(argv[i + 1]);
+		else if(!strcmp(argv[i], "-x"))
+			seed = strtoull(argv[i + 1], NULL, 10);
+		else
+		{
+			usage();
+			return 1;
+		}
+	}
+
+	cTrisEngine check;
+	if(check.setWidth(width) || check.setHeight(height))
+	{
+		printf("| Board must be 4 to %d wide and 6 to %d high\n",
+			BOARD_MAX_WIDTH, BOARD_MAX_HEIGHT);
+		return 1;
+	}
+
+	int maxDepth = beam > 0 ? BOT_MAXBEAMDEPTH : BOT_MAXDEPTH;
+	if(games < 1 || depth < 1 || depth > maxDepth)
+	{
+		printf("| Need at least one game and a depth of 1 to %d\n", maxDepth);
+		return 1;
+	}
+
+	vector<cBotWeights> weights;
+	if(weightFile)
+	{
+		if(readWeights(weights, weightFile))
+		{
+			printf("| Unable to read weight sets\n");
+			return 1;
+		}
+	}
+	else
+		drawWeights(weights, sets < 1 ? 1 : sets, seed);
+
+	cSelfPlay batch(weights, games);
+	batch.mDepth = depth;
+	batch.mBeam = beam;
+	batch.mLimit = limit;
+	batch.mWidth = width;
+	batch.mHeight = height;
+	batch.mLevel = level;
+	batch.mSeed = seed;
+
+	cWorkPool pool(threads);
+
+	printf("| Blue Tetris Self-Play\n| %d weight sets, %d games each, depth %d, beam %d, %d threads\n\n",
+		(int)weights.size(), games, depth, beam, pool.threads());
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	pool.run(batch.tasks(), batch);
+
+	std::chrono::duration<double> span = std::chrono::steady_clock::now() - start;
+	batch.report(span.count());
+
+	return 0;
+}
@@ -10,18 +10,33 @@
 //
 //***************************************************************************************
 
-#include <conio.h>
+#include <stdio.h>
 #include "BTServer.h"
 
-void main()
+#ifdef _WIN32
+#include <conio.h>
+#include <thread>
+#else
+#include <signal.h>
+#include <string.h>
+
+// Ends server execution on interrupt or termination
+void BTSSignal(int /*signal*/)
+{
+	BTSStop();
+}
+#endif
+
+int main(int argc, char* argv[])
 {
 	try
 	{
+		printf("| Blue Tetris Server.\n| Version 2.0\n\n");
+
+#ifdef _WIN32
 		char selection;
 		int mode;
 
-		printf("| Blue Tetris Server.\n| Version 2.0\n\n");
-
 		printf("| Press 's' to start in sql server mode.\n| Press any other key to start in local data mode.\n\n");
 
 		selection = getch();
@@ -37,19 +52,45 @@ void main()
 			printf("| Local data mode selected\n");
 		}
 
-		AfxBeginThread(BTSRun,(LPVOID)mode);
+		std::thread server(BTSRun, mode);
 		printf("| Now running\n| Press escape to end execution.\n\n");
 		while(_getch()!=27);
 
-		mEndExecution = true;
-		closesocket(mServer);
+		BTSStop();
+		server.join();
 		WSACleanup();
+#else
+		int mode(0);
+
+#ifdef BTS_SQL_MODE
+		if(argc > 1 && !strcmp(argv[1], "-s"))		// Start in sql server mode
+			mode = 1;
+#else
+		(void)argc;									// Only local data mode is available
+		(void)argv;
+#endif
+
+		if(mode)
+			printf("| SQL Database mode selected\n");
+		else
+			printf("| Local data mode selected\n");
+
+		signal(SIGINT, BTSSignal);
+		signal(SIGTERM, BTSSignal);
+
+		printf("| Now running\n| Press Ctrl+C to end execution.\n\n");
+		if(BTSRun(mode))
+			printf("| Unable to listen on port %d\n", BT_PORT);
+#endif
 	}
 	catch(...)
 	{
 		printf("\n\nUnhandled exception occurred...\n\n");
+#ifdef _WIN32
 		WSACleanup();
+#endif
 	}
 
 	printf("Server down.\n");
-}
\ No newline at end of file
+	return 0;
+}
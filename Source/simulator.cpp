@@ -0,0 +1,367 @@
+//***************************************************************************************
+//
+//	Date Created:	October 17, 2026
+//	File:			simulator.cpp
+//	Project:		Blue Tetris
+//
+//	Purpose:		Headless game simulator. Plays full games on the rules engine as
+//					fast as it will go, with input chosen by a policy, and reports
+//					throughput and line clear statistics. No rendering, no timers.
+//
+//					btsim [options]
+//						-n games		Games to play (default 1000)
+//						-p policy		random, script or replay (default random)
+//						-s keys			Script keys for script policy (LRDSABG)
+//						-r file			Replay file for replay policy
+//						-w width		Board width (default 10)
+//						-h height		Board height (default 22)
+//						-l level		Starting level (default 0)
+//						-x seed			Seed of first game (default 1)
+//						-m moves		Input limit per game (default 100000)
+//						-u				Draw tetrads randomly, not by permutation
+//						-v file			Check replays instead: plays server-fed games
+//										as a multiplayer client does, records each to
+//										file, plays it back and compares the boards
+//
+//***************************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include "policy.h"
+
+#define SIM_GAMES		1000			// Defaults
+#define SIM_SEED		1
+#define SIM_MOVELIMIT	100000
+
+//***************************************************************************************
+//
+//	Class:		cSimulation
+//	Purpose:	Totals gathered over all games played
+//
+//***************************************************************************************
+class cSimulation
+{
+public:
+	cSimulation(): mGames(0), mMoves(0), mPieces(0), mScore(0), mFinished(0)
+		{ for(int i(0); i < 4; i++) mClears[i] = 0; }
+
+	void play(cPolicy &policy, cTrisEngine &board, int games, int limit);
+	void report(double seconds);
+
+private:
+
+	long long mGames;						// Games played
+	long long mMoves;						// Input events applied
+	long long mPieces;						// Tetrads locked
+	long long mClears[4];					// Line clears by size
+	long double mScore;						// Total score
+	long long mFinished;					// Games that reached game over
+};
+
+//***************************************************************************************
+//
+//	Function:	play
+//	Purpose:	Plays games until each ends, its policy stops or it reaches the
+//				input limit
+//
+//***************************************************************************************
+void cSimulation::play(cPolicy &policy, cTrisEngine &board, int games, int limit)
+{
+	int event;
+	int moves;
+	bool active;
+
+	for(int game(0); game < games; game++)
+	{
+		if(policy.begin(board, game))
+			return;
+
+		for(moves = 0; moves < limit && !board.gameOver(); moves++)
+		{
+			event = policy.next(board);
+			if(event == POLICY_STOP)
+				break;
+
+			active = (board.getTetradPtr() != NULL);
+			if(cReplayReader::execute(board, event) > 0 && active &&
+				(event == I_DOWN || event == I_SONIC_LOCK || event == I_GRAVITY))
+				mPieces++;
+		}
+
+		mGames++;
+		mMoves += moves;
+		mScore += board.score();
+		mClears[0] += board.singles();
+		mClears[1] += board.doubles();
+		mClears[2] += board.triples();
+		mClears[3] += board.tetrises();
+
+		if(board.gameOver())
+			mFinished++;
+	}
+}
+
+//***************************************************************************************
+//
+//	Function:	report
+//	Purpose:	Prints throughput and statistics
+//
+//***************************************************************************************
+void cSimulation::report(double seconds)
+{
+	long long lines = mClears[0] + 2 * mClears[1] + 3 * mClears[2] + 4 * mClears[3];
+
+	if(seconds <= 0)
+		seconds = 1e-9;
+
+	printf("| Games:       %lld (%lld to game over)\n", mGames, mFinished);
+	printf("| Time:        %.3f s\n", seconds);
+	printf("| Games/sec:   %.1f\n", mGames / seconds);
+	printf("| Pieces/sec:  %.0f\n", mPieces / seconds);
+	printf("| Inputs/sec:  %.0f\n", mMoves / seconds);
+	printf("| Pieces:      %lld\n", mPieces);
+	printf("| Lines:       %lld (%lld singles, %lld doubles, %lld triples, %lld tetrises)\n",
+		lines, mClears[0], mClears[1], mClears[2], mClears[3]);
+
+	if(mGames > 0)
+		printf("| Mean score:  %.1Lf\n", mScore / mGames);
+	if(mPieces > 0)
+		printf("| Lines/piece: %.4f\n", (double)lines / mPieces);
+}
+
+//***************************************************************************************
+//
+//	Function:	verify
+//	Purpose:	Plays games on a board fed tetrad lists from outside, as a
+//				multiplayer client's is, recording every input and list to a
+//				replay file. Each replay is then played back on a fresh board and
+//				the two boards compared.
+//	Return:		Number of games whose playback did not match
+//
+//***************************************************************************************
+int verify(cPolicy &policy, cTrisEngine &board, int games, int limit,
+	unsigned long long seed, const char* path)
+{
+	cTrisEngine client;
+	cTrisEngine playback;
+	cReplayWriter writer;
+	cReplayReader reader;
+	cTetrad* live;
+	cTetrad* played;
+	cRandom deal;
+	int list[7];
+	int event;
+	int moves;
+	int failed(0);
+	bool match;
+
+	for(int game(0); game < games; game++)
+	{
+		if(policy.begin(board, game))
+			break;
+
+		client = cTrisEngine(board.width(), board.height(), false, board.level());
+		client.setAutonomy(false);
+		deal.seed(seed + game);
+
+		if(writer.open(path, 0, client.width(), client.height(), client.level(),
+			REPLAY_SERVER))
+		{
+			printf("| Unable to write %s\n", path);
+			return games;
+		}
+
+		for(moves = 0; moves < limit && !client.gameOver(); moves++)
+		{
+			if(client.preview(1) < 0)		// Deal next permutation when drawn out
+			{
+				for(int i(0); i < 7; i++)
+					list[i] = i;
+				for(int i(6); i > 0; i--)
+				{
+					int j = deal.range(i + 1);
+					int type = list[i];
+					list[i] = list[j];
+					list[j] = type;
+				}
+
+				client.setNext(list);
+				writer.recordList(list, moves);
+			}
+
+			if(moves == 0)
+				client.start();
+
+			event = policy.next(client);
+			if(event == POLICY_STOP)
+				break;
+
+			writer.record(event, moves);
+			cReplayReader::execute(client, event);
+		}
+
+		writer.close();
+
+		if(reader.open(path))
+		{
+			printf("| Unable to read %s\n", path);
+			return games;
+		}
+
+		reader.prepare(playback);
+		reader.play(playback);
+
+		live = client.getTetradPtr();
+		played = playback.getTetradPtr();
+		match = (client.score() == playback.score() &&
+			client.gameOver() == playback.gameOver() && (live == NULL) == (played == NULL));
+
+		for(int y(0); y < client.height() && match; y++)
+			match = (client.row(y) == playback.row(y));
+
+		for(int i(0); i < 4 && match && live; i++)
+			match = (live->x(i) == played->x(i) && live->y(i) == played->y(i));
+
+		if(!match)
+		{
+			if(!failed)
+				printf("| Game %d: playback does not match after %d inputs\n", game, moves);
+			failed++;
+		}
+	}
+
+	return failed;
+}
+
+//***************************************************************************************
+//
+//	Function:	usage
+//	Purpose:	Prints command line help
+//
+//***************************************************************************************
+void usage()
+{
+	printf("usage: btsim [-n games] [-p random|script|replay] [-s keys] [-r file]\n"
+		"             [-w width] [-h height] [-l level] [-x seed] [-m moves] [-u]\n"
+		"             [-v file]\n");
+}
+
+int main(int argc, char* argv[])
+{
+	int games(SIM_GAMES);
+	int width(BOARDWIDTH);
+	int height(BOARDDEPTH);
+	int level(0);
+	int limit(SIM_MOVELIMIT);
+	unsigned long long seed(SIM_SEED);
+	bool permute(true);
+	const char* policyName = "random";
+	const char* script = "";
+	const char* replayFile = NULL;
+	const char* verifyFile = NULL;
+
+	for(int i(1); i < argc; i++)
+	{
+		bool hasValue = (i + 1 < argc);
+
+		if(!strcmp(argv[i], "-u"))
+			permute = false;
+		else if(!hasValue)
+		{
+			usage();
+			return 1;
+		}
+		else if(!strcmp(argv[i], "-n"))
+			games = atoi(argv[++i]);
+		else if(!strcmp(argv[i], "-p"))
+			policyName = argv[++i];
+		else if(!strcmp(argv[i], "-s"))
+			script = argv[++i];
+		else if(!strcmp(argv[i], "-r"))
+			replayFile = argv[++i];
+		else if(!strcmp(argv[i], "-w"))
+			width = atoi(argv[++i]);
+		else if(!strcmp(argv[i], "-h"))
+			height = atoi(argv[++i]);
+		else if(!strcmp(argv[i], "-l"))
+			level = atoi(argv[++i]);
+		else if(!strcmp(argv[i], "-x"))
+			seed = strtoull(argv[++i], NULL, 10);
+		else if(!strcmp(argv[i], "-m"))
+			limit = atoi(argv[++i]);
+		else if(!strcmp(argv[i], "-v"))
+			verifyFile = argv[++i];
+		else
+		{
+			usage();
+			return 1;
+		}
+	}
+
+	cTrisEngine board;
+	if(board.setWidth(width) || board.setHeight(height))
+	{
+		printf("| Board must be 4 to %d wide and 6 to %d high\n",
+			BOARD_MAX_WIDTH, BOARD_MAX_HEIGHT);
+		return 1;
+	}
+	board = cTrisEngine(width, height, permute, level);
+
+	cRandomPolicy randomPolicy(seed);
+	cScriptPolicy scriptPolicy;
+	cReplayPolicy replayPolicy;
+	cPolicy* policy;
+
+	if(!strcmp(policyName, "random"))
+		policy = &randomPolicy;
+	else if(!strcmp(policyName, "script"))
+	{
+		if(scriptPolicy.load(script))
+		{
+			printf("| Script must be a sequence of the keys LRDSABG\n");
+			return 1;
+		}
+		policy = &scriptPolicy;
+	}
+	else if(!strcmp(policyName, "replay"))
+	{
+		if(!replayFile || replayPolicy.open(replayFile))
+		{
+			printf("| Unable to read replay\n");
+			return 1;
+		}
+		policy = &replayPolicy;
+	}
+	else
+	{
+		usage();
+		return 1;
+	}
+
+	policy->setSeed(seed);
+
+	if(verifyFile)
+	{
+		printf("| Blue Tetris Simulator\n| Checking %d replays, %s policy\n\n", games,
+			policyName);
+
+		int failed = verify(*policy, board, games, limit, seed, verifyFile);
+		printf("| Replays:     %d of %d match\n", games - failed, games);
+
+		return failed ? 1 : 0;
+	}
+
+	printf("| Blue Tetris Simulator\n| %d games, %s policy\n\n", games, policyName);
+
+	cSimulation simulation;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	simulation.play(*policy, board, games, limit);
+
+	std::chrono::duration<double> span = std::chrono::steady_clock::now() - start;
+	simulation.report(span.count());
+
+	return 0;
+}
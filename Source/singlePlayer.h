@@ -17,6 +17,7 @@
 #include "trisboard.h"
 #include "keymap.h"
 #include "sound.h"
+#include "replay.h"
 #include <vector>
 #include <atltime.h>			// For time manipulation
 #include <string>
@@ -32,6 +33,8 @@ using std::vector;
 #define ARRAY_ROTATE_RIGHT	5
 #define ARRAY_PAUSE			6
 
+#define SP_REPLAYFILE		"Data/lastgame.btr"	// Replay of most recent game
+
 //***************************************************************************************
 //
 //	Class:		cSinglePlayer
@@ -66,6 +69,7 @@ private:
 	virtual void resetCountdown();		// Resets active tetrad drop counter
 
 	void forceCheck();					// Forces tetrad downward at timed intervals
+	void record(int event);				// Logs input event to replay
 
 	cTrisBoard mBoard;					// Member board
 	cKeymap mKeymap;					// Keymapping
@@ -77,6 +81,7 @@ private:
 	CFileTimeSpan mTotalTime;			// Logs total time for postgame
 
 	int mBoardState;					// Pregame / Active / Pause / Postgame
+	cReplayWriter mReplay;				// Records game for playback
 
 	bool mKeylist[7];					// Array for keydown tracking
 	int mRepeat[7];						// Array for key repeat tracking
@@ -202,7 +207,10 @@ int cSinglePlayer::advanceGame()
 			resetCountdown();
 			mStartTime = CFileTime::GetCurrentTime();	// Store starting time
 			mBoardState = BS_ACTIVE;					// Set state to active
+			mBoard.setSeed(mStartTime.GetTime());		// New tetrad sequence each game
 			mBoard.start();
+			mReplay.open(SP_REPLAYFILE, mStartTime.GetTime(), mBoard.width(), mBoard.height(),
+				mBoard.level(), mBoard.permutation() ? REPLAY_PERMUTE : 0);
 		}
 	}
 
@@ -248,6 +256,7 @@ bool cSinglePlayer::executeCommand()
 	{
 		int cleared;
 		
+		record(I_SONIC_LOCK);
 		if(mBoard.sonicLock(cleared))
 			playSound(SOUND_LOCK);
 
@@ -259,6 +268,7 @@ bool cSinglePlayer::executeCommand()
 	{
 		int cleared;
 		
+		record(I_DOWN);
 		if(mBoard.moveDown(cleared))
 			playSound(SOUND_LOCK);
 
@@ -269,13 +279,20 @@ bool cSinglePlayer::executeCommand()
 	}
 
 	if(mKeylist[ARRAY_RIGHT] && (mRepeat[ARRAY_RIGHT] == 0 || mRepeat[ARRAY_RIGHT] > 3) )
+	{
+		record(I_RIGHT);
 		mBoard.moveRight();
+	}
 
 	if(mKeylist[ARRAY_LEFT] && (mRepeat[ARRAY_LEFT] == 0 || mRepeat[ARRAY_LEFT] > 3) )
+	{
+		record(I_LEFT);
 		mBoard.moveLeft();
+	}
 
 	if(mKeylist[ARRAY_ROTATE_LEFT] && !mRepeat[ARRAY_ROTATE_LEFT])
 	{
+		record(I_ROTATE_LEFT);
 		rvalue = mBoard.rotateLeft();
 
 		if(rvalue == 1)
@@ -286,6 +303,7 @@ bool cSinglePlayer::executeCommand()
 
 	if(mKeylist[ARRAY_ROTATE_RIGHT] && !mRepeat[ARRAY_ROTATE_RIGHT])
 	{
+		record(I_ROTATE_RIGHT);
 		rvalue =  mBoard.rotateRight();
 		if(rvalue == 1)
 			playSound(SOUND_COLLISION);
@@ -299,6 +317,7 @@ bool cSinglePlayer::executeCommand()
 	{
 		mTotalTime = CFileTime::GetTickCount() - mStartTime;
 		mBoardState = BS_POSTGAME;
+		mReplay.close();
 	}
 
 	return error;
@@ -320,6 +339,7 @@ void cSinglePlayer::forceCheck()
 		mLastDropTime += BTDropInterval(mBoard.level()) * 10000;
 		timeDiff = CFileTime::GetCurrentTime() - mLastDropTime;
 		
+		record(I_GRAVITY);
 		if(mBoard.forceDown(cleared))			// Force tetrad downward
 			playSound(SOUND_LOCK);
 
@@ -328,6 +348,20 @@ void cSinglePlayer::forceCheck()
 	}
 }
 
+//**************************************************************************************
+//
+//	Function:	record
+//	Purpose:	Logs input event to the game's replay, stamped with the time in
+//				play; paused time is not counted
+//
+//**************************************************************************************
+void cSinglePlayer::record(int event)
+{
+	CFileTimeSpan time = CFileTime::GetCurrentTime() - mStartTime;
+
+	mReplay.record(event, time.GetTimeSpan() / 10000);
+}
+
 //**************************************************************************************
 //
 //	Function:	resetCountdown
@@ -16,17 +16,20 @@
 #include "afx.h"
 #include "resource.h"
 
-#include <queue>
 #include <string>
-using std::queue;
+#include "ringbuffer.h"
+#include "frame.h"
 using std::string;
 
+#define CONNECTION_QUEUESIZE	1024	// Capacity of each message queue
+
 // Message pump function declaration
 UINT BTCRead(LPVOID pParam);
 UINT BTCSend(LPVOID pParam);
+bool BTCReceiveFrame(SOCKET socket, string &message);
 
-queue<string> mOutgoing;			// Outgoing message queue
-queue<string> mIncoming;			// Incoming message queue
+cMPSCRing<string> mOutgoing(CONNECTION_QUEUESIZE);	// Outgoing message queue
+cSPSCRing<string> mIncoming(CONNECTION_QUEUESIZE);	// Incoming message queue
 bool readThreadError(false);
 bool sendThreadError(false);
 
@@ -105,6 +108,7 @@ void cConnection::disconnect()
 	{
 		readThreadError = true;
 		sendThreadError = true;
+		mOutgoing.tryPush(string());			// Wake send thread so it can exit
 	}
 
 	mConnected = false;
@@ -122,8 +126,8 @@ bool cConnection::initConnection(const char* address)
 {
 	bool error(false);								// Error flag
 
-	mIncoming.empty();								// Initialize queues
-	mOutgoing.empty();
+	mIncoming.clear();								// Initialize queues
+	mOutgoing.clear();
 
 	readThreadError = false;						// Initialize error flags
 	sendThreadError = false;
@@ -131,8 +135,7 @@ bool cConnection::initConnection(const char* address)
 	hostent *hp;
 	sockaddr_in server;
 	unsigned int addr;
-	int r;											// Message return value
-	char buff[MESSAGE_BUFFSIZE];					// Message buffer
+	string message;									// First message from server
 	WSADATA wsaData;
 
 	int wsaret=WSAStartup(0x101,&wsaData);
@@ -178,17 +181,13 @@ bool cConnection::initConnection(const char* address)
 
 				if(!error)
 				{
-					r=recv(mConn,buff,MESSAGE_BUFFSIZE,0);	// Get response from server
-					buff[r]=0;
-
-					if(r==SOCKET_ERROR)
+					if(BTCReceiveFrame(mConn, message))	// Get response from server
 					{
 						mConnected = false;
 					}
 					else									// Connection Success
 					{
-						buff[r] = '\0';						// Add null terminator
-						mIncoming.push(string(buff));		// Push message on queue
+						mIncoming.push(message);			// Push message on queue
 
 						mConnected = true;
 
@@ -264,17 +263,7 @@ string cConnection::encode(const int state, const int message)
 //***************************************************************************************
 bool cConnection::dequeue(string &msg)
 {
-	bool isEmpty(false);
-
-	if(!mIncoming.empty())
-	{	
-		msg = mIncoming.front();
-		mIncoming.pop();
-	}
-	else
-		isEmpty = true;
-
-	return isEmpty;
+	return mIncoming.tryPop(msg);
 }
 
 //--------------------------------------------------------------------------------------O
@@ -286,7 +275,8 @@ bool cConnection::dequeue(string &msg)
 //***************************************************************************************
 //
 //	Function:	BTCRead
-//	Purpose:	Thread that reads and stores messages from the server
+//	Purpose:	Thread that reads and stores messages from the server. Bytes are
+//				kept until they form a whole frame, so frames may span reads.
 //
 //***************************************************************************************
 UINT BTCRead(LPVOID pParam)
@@ -295,40 +285,38 @@ UINT BTCRead(LPVOID pParam)
 
 	SOCKET socket=(SOCKET)pParam;				// Cast socket from sent parameter
 	char buff[MESSAGE_BUFFSIZE];				// Buffer for reading from server
-	char message[MESSAGE_BUFFSIZE];				// Second buffer for parsing
+	string input;								// Bytes not yet parsed
+	cFrame frame;								// Frame being parsed
 	bool sockError(false);						// Error flag
 	int r;										// Return value for message pump
-	int i, j;									// Index variables
-	string temp;
+	int used;									// Bytes consumed by complete frames
+	int size;									// Size of current frame
 
 	while(!sockError && !readThreadError)		// Until error occurs
 	{
 		r=recv(socket,buff,MESSAGE_BUFFSIZE,0);	// Read message from client
 
-		if(r == SOCKET_ERROR)					// Check for error/disconnection
+		if(r == SOCKET_ERROR || r == 0)			// Check for error/disconnection
 			sockError = true;
 		else
 		{
-			for(i = 0, j = 0; i < r; i++)				// For each character in the buffer
-			{
-				if((unsigned char)buff[i] == MESSAGE_TERMINATOR)		// If end of message
-				{
-					message[j] = '\0';					// Null terminate message
-					mIncoming.push(string(message));	// Push on message queue
-					j = 0;								// Reset position in message buffer
-				}
-				else									// If not end of message
-				{
-					message[j] = buff[i];				// Append character to message buffer
-					j++;								// Increment position in message buffer
-				}
-			}
+			input.append(buff, r);
+
+			for(used = 0; (size = frame.parse(input.data() + used, (int)input.length() - used)) > 0;
+				used += size)
+				mIncoming.push(frame.message());	// Push on message queue
+
+			input.erase(0, used);
+
+			if(size == FRAME_MALFORMED)			// Stream out of step with server
+				sockError = true;
 		}
 	}
 
 	closesocket(socket);						// Close the socket
 
 	readThreadError = true;
+	mOutgoing.tryPush(string());				// Wake send thread so it can exit
 	printf("Read thread disconnected\n");		// Debug code
 
 	return 0;
@@ -337,7 +325,10 @@ UINT BTCRead(LPVOID pParam)
 //***************************************************************************************
 //
 //	Function:	BTCSend
-//	Purpose:	Thread that sends messages to the server
+//	Purpose:	Thread that sends messages to the server. Sleeps while there is
+//				nothing to send; an empty message only wakes it to check for errors.
+//				Every message queued by the time it wakes goes out in one send, so
+//				Nagle's algorithm is disabled rather than left to delay them.
 //
 //***************************************************************************************
 UINT BTCSend(LPVOID pParam)
@@ -346,23 +337,25 @@ UINT BTCSend(LPVOID pParam)
 
 	SOCKET socket = (SOCKET)pParam;				// Cast parameter to get the socket
 	int r;										// Return value for message pump
-	int length;									// Stores buffer length
-	char buff[MESSAGE_BUFFSIZE];				// Message buffer
+	int noDelay(1);								// Disables Nagle's algorithm
+	string buff;								// Encoded frames
 	bool sockError(false);						// Error flag
+	string message;								// Message taken from queue
+
+	setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, (const char*)&noDelay, sizeof(noDelay));
 
 	while(!sockError && !readThreadError)		// Until error occurs
 	{
-		if(!mOutgoing.empty())					// If message in queue, send message
-		{
-			sprintf(buff, mOutgoing.front().c_str());
-			mOutgoing.pop();
+		mOutgoing.waitPop(message);				// Wait for a message
 
-			length = strlen(buff);				// Append message terminator
-			buff[length] = MESSAGE_TERMINATOR;
-			buff[length + 1] = '\0';
-			length++;
+		buff.clear();
+		do										// Gather everything already queued
+			cFrame::encode(buff, message);
+		while(!mOutgoing.tryPop(message));
 
-			r=send(socket, buff, strlen(buff), 0);
+		if(!readThreadError && !buff.empty())
+		{
+			r=send(socket, buff.data(), (int)buff.length(), 0);
 
 			if(r==SOCKET_ERROR)					// Check for socket errors
 				sockError = true;
@@ -373,4 +366,47 @@ UINT BTCSend(LPVOID pParam)
 	printf("Send thread disconnected\n");		// Debug code
 
 	return 0;
-}
\ No newline at end of file
+}
+
+//***************************************************************************************
+//
+//	Function:	BTCReceiveFrame
+//	Purpose:	Reads exactly one frame from the server, leaving any later bytes
+//				for the read thread
+//	Return:		True if error occurs; message returned by reference
+//
+//***************************************************************************************
+bool BTCReceiveFrame(SOCKET socket, string &message)
+{
+	char buff[FRAME_HEADERSIZE + FRAME_MAXPAYLOAD];	// Frame buffer
+	cFrame frame;
+	int length(0);								// Bytes read so far
+	int needed(FRAME_HEADERSIZE);				// Bytes known to be in frame
+	int size;									// Result of parsing
+	int r;
+
+	while(length < needed)
+	{
+		r = recv(socket, buff + length, needed - length, 0);
+
+		if(r == SOCKET_ERROR || r == 0)
+			return true;
+
+		length += r;
+
+		if(length == FRAME_HEADERSIZE)			// Header complete: payload size known
+		{
+			size = frame.parse(buff, length);
+
+			if(size == FRAME_MALFORMED)
+				return true;
+
+			needed = FRAME_HEADERSIZE + frame.mLength;
+		}
+	}
+
+	frame.parse(buff, length);
+	message = frame.message();
+
+	return false;
+}
@@ -0,0 +1,112 @@
+//***************************************************************************************
+//
+//	Date Created:	October 17, 2026
+//	File:			tetrad.cpp
+//	Project:		Blue Tetris
+//
+//	Purpose:		Function definitions for cTetrad
+//
+//***************************************************************************************
+
+#include "tetrad.h"
+
+//***************************************************************************************
+//
+//	Function:		Default Constructor
+//	Purpose:		Initializes member data
+//
+//***************************************************************************************
+cTetrad::cTetrad(): mType(0), mRotation(0), mxOrigin(0), myOrigin(0)
+{
+}
+
+//***************************************************************************************
+//
+//	Function:		Value Constructor
+//	Purpose:		Initializes tetrad of given type
+//
+//***************************************************************************************
+cTetrad::cTetrad(int type, int boardWidth, int boardHeight)
+{
+	generate(type, boardWidth, boardHeight);
+}
+
+//***************************************************************************************
+//
+//	Function:		generate
+//	Purpose:		Forms tetrad of shape corresponding to given value in spawn
+//					orientation; Initializes tetrad's location on board
+//	Returns:		True if error is encountered in tetrad generation
+//
+//***************************************************************************************
+bool cTetrad::generate(int type, int boardWidth, int boardHeight)
+{
+	bool error(false);				// Flags error in tetrad creation
+
+	if(type < 0 || type > 6)		// Catch invalid types
+	{
+		type = 0;
+		error = true;
+	}
+
+	mType = type;					// Store type
+	mRotation = 0;
+
+	mxOrigin = boardWidth / 2 - 1;	// Coordinates of tetrad's "center" unit
+	myOrigin = boardHeight - 2;
+
+	return error;
+}
+
+//***************************************************************************************
+//
+//	Function:	unit
+//	Purpose:	Getter for member units
+//	Returns:	The member unit of given index
+//
+//***************************************************************************************
+cTrisUnit cTetrad::unit(int i)
+{
+	if(i < 0)
+		i = 0;
+	if(i > 3)
+		i = 3;
+
+	return cTrisUnit(x(i), y(i), mType);
+}
+
+//***************************************************************************************
+//
+//	Function:	setUnits
+//	Purpose:	Sets location of each unit within tetrad
+//				Origin and orientation are recovered from the given coordinates
+//	Returns:	True if coordinates do not form an orientation of this tetrad
+//
+//***************************************************************************************
+bool cTetrad::setUnits(int* x, int* y)
+{
+	bool invalid(true);
+
+	for(int r(0); r < 4 && invalid; r++)	// Try each orientation
+	{
+		int xOrigin = x[0] - TETRAD_OFFSETS[mType][r][0][0];
+		int yOrigin = y[0] - TETRAD_OFFSETS[mType][r][0][1];
+
+		invalid = false;
+		for(int i(1); i < 4 && !invalid; i++)
+		{
+			if(x[i] != xOrigin + TETRAD_OFFSETS[mType][r][i][0] ||
+			   y[i] != yOrigin + TETRAD_OFFSETS[mType][r][i][1])
+				invalid = true;
+		}
+
+		if(!invalid)
+		{
+			mRotation = r;
+			mxOrigin = xOrigin;
+			myOrigin = yOrigin;
+		}
+	}
+
+	return invalid;
+}
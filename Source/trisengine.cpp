@@ -0,0 +1,898 @@
+//***************************************************************************************
+//
+//	Date Created:	October 17, 2026
+//	File:			trisengine.cpp
+//	Project:		Blue Tetris
+//
+//	Purpose:		Function definitions for cTrisEngine, the Blue Tetris rules engine
+//
+//***************************************************************************************
+
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BT_SSE2								// Vectorized line detection available
+#include <emmintrin.h>
+#endif
+
+#include "trisengine.h"
+
+//***************************************************************************************
+//
+//	Function:	default constructor
+//	Purpose:	Intializes board with defaulted dimensions
+//
+//***************************************************************************************
+cTrisEngine::cTrisEngine(): mActive(false), mNext(false), mIndex(7), mxSize(BOARDWIDTH),
+mySize(BOARDDEPTH), mPermute(true), mAutonomous(true), mLevel(0), mGameOver(false)
+{ 
+	initBoard();
+}
+
+//***************************************************************************************
+//
+//	Function:	value constructor
+//	Purpose:	Initializes board with given dimensions
+//
+//***************************************************************************************
+cTrisEngine::cTrisEngine(int columns, int rows, bool permute, int level):
+mActive(false), mNext(false), mIndex(7), mxSize(columns), mySize(rows),
+mPermute(permute), mAutonomous(true), mLevel(level), mGameOver(false)
+{
+	initBoard();
+}
+
+//***************************************************************************************
+//
+//	Function:	start
+//	Purpose:	Puts playing board in active state
+//
+//***************************************************************************************
+void cTrisEngine::start()
+{
+	mGameOver = false;
+	primeTetrads();
+}
+
+//***************************************************************************************
+//
+//	Function:	setNext
+//	Purpose:	Populates list of upcoming tetrads
+//
+//***************************************************************************************
+void cTrisEngine::setNext(int list[])
+{
+	for(int i(0); i < 7; i++)
+		mTetradList[i] = list[i];
+
+	mIndex = 0;
+}
+
+//***************************************************************************************
+//
+//	Function:	preview
+//	Purpose:	Looks ahead in the tetrad queue: 0 is the next tetrad, then the
+//				list entries not yet drawn
+//	Return:		Tetrad type; -1 if the queue does not reach that far
+//
+//***************************************************************************************
+int cTrisEngine::preview(int n)
+{
+	if(n == 0)
+		return mNext ? mNextTetrad.type() : -1;
+
+	if(n < 0 || mIndex + n - 1 > 6)
+		return -1;
+
+	return mTetradList[mIndex + n - 1];
+}
+
+//***************************************************************************************
+//
+//	Function:	primeTetrads
+//	Purpose:	Draws initial tetrad sequence and assigns active and next tetrad members
+//
+//***************************************************************************************
+void cTrisEngine::primeTetrads()
+{
+	if(mAutonomous)
+	{
+		drawTetrads();
+		mActiveTetrad.generate(mTetradList[0], mxSize, mySize);
+		mNextTetrad.generate(mTetradList[1], mxSize, mySize);
+		mActive = true;
+		mNext = true;
+		mIndex = 2;
+	}
+}
+
+//***************************************************************************************
+//
+//	Function:	nextTetrad
+//	Purpose:	Advances to next tetrad:
+//				Active Tetrad = Next Tetrad
+//				Next Tetrad = new tetrad from list
+//
+//***************************************************************************************
+void cTrisEngine::nextTetrad()
+{
+	if(!mGameOver)
+	{
+		mActiveTetrad = mNextTetrad;	// Next becomes active
+		mActive = mNext;
+
+		if(mIndex > 6)					// If end of list reached
+		{
+			if(mAutonomous)
+			{
+				if(mPermute)
+					drawTetrads();				// Permute new list
+				else
+					drawRandomTetrads();		// Draw new random list
+			}
+		}
+
+		if(mIndex < 7)
+		{
+			mNextTetrad.generate(mTetradList[mIndex], mxSize, mySize);	// Draw new next
+			mNext = true;
+			mIndex++;						// Increase index in list of next tetrads
+		}
+		else
+			mNext = false;
+	}
+}
+
+//***************************************************************************************
+//
+//	Function:	redraw
+//	Purpose:	Forces redraw of next tetrad set
+//
+//***************************************************************************************
+void cTrisEngine::redraw()
+{
+	if(mPermute)
+		drawTetrads();
+	else
+		drawRandomTetrads();
+}
+
+//***************************************************************************************
+//
+//	Function:	drawTetrad
+//	Purpose:	Draws individual tetrad randomly
+//
+//***************************************************************************************
+void cTrisEngine::drawRandomTetrads()
+{
+	int temp, a;
+
+	for(int i(0); i < 7; i++)		// Populate list
+		mTetradList[i] = mRandom.range(7);
+
+	for(int i(0); i < 7; i++)		// Shuffle list
+	{
+		a = mRandom.range(7);
+		temp = mTetradList[i];
+		
+		if(mTetradList[i] == mTetradList[a])
+			mTetradList[i] = mRandom.range(7);
+		else
+			mTetradList[i] = mTetradList[a];
+
+		mTetradList[a] = temp;
+	}
+
+	mIndex = 0;
+}
+
+//***************************************************************************************
+//
+//	Function:	drawTetrads
+//	Purpose:	Fills tetrad list with a set of all seven tetrads, permuted
+//				Behavior reflects The Tetris Company's "Random Generator" algorithm
+//
+//***************************************************************************************
+void cTrisEngine::drawTetrads()
+{
+	int temp, a;
+
+	for(int i(0); i < 7; i++)		// Populate list
+		mTetradList[i] = i;
+
+	for(int i(6); i > 0; i--)		// Shuffle list (Fisher-Yates)
+	{
+		a = mRandom.range(i + 1);
+		temp = mTetradList[i];
+		mTetradList[i] = mTetradList[a];
+		mTetradList[a] = temp;
+	}
+
+	mIndex = 0;						// Reset list index
+}
+
+//***************************************************************************************
+//
+//	Function:	initBoard
+//	Purpose:	Initializes playing board
+//
+//***************************************************************************************
+void cTrisEngine::initBoard()
+{
+	int i;
+
+	checkWidth();								// Board storage is of fixed size
+	checkHeight();
+
+	// Initialize board data
+	mFullRow = (1u << mxSize) - 1;
+
+	for(i = 0; i < BOARD_ROW_STORAGE; i++)		// Rows beyond height stay empty
+		clearLine(i);
+
+	// Initialize statistic data
+	mScore = 0;
+
+	mRemaining = mLevel * 10;
+	if(mRemaining < 10)
+		mRemaining = 10;
+	if(mRemaining > 100)
+		mRemaining = 100;
+
+	for(i = 0; i < 4; i++)
+		mClears[i] = 0;
+}
+
+//***************************************************************************************
+//
+//	Function:	clear
+//	Purpose:	Clears all units from the board
+//
+//***************************************************************************************
+void cTrisEngine::clear()
+{
+	for(int y = 0; y < mySize; y++)				// For each row
+		clearLine(y);
+}
+
+//***************************************************************************************
+//
+//	Function:	remove
+//	Purpose:	Removes the tetris unit in the specified row and column
+//	Return:		True if block is not present
+//
+//***************************************************************************************
+bool cTrisEngine::remove(int rx, int ry)
+{
+	if(check(rx, ry) && !erase(rx, ry))
+		return false;
+	else
+		return true;
+}
+
+//***************************************************************************************
+//
+//	Function:	add
+//	Purpose:	Introduces a new unit to the grid
+//	Return:		True if invalid location for current board metrics
+//
+//***************************************************************************************
+bool cTrisEngine::add(int x, int y, int face)
+{
+	bool invalid(false);
+
+	if(x < 0 || x >= mxSize || y < 0 || y >= mySize)
+		invalid = true;
+	else
+	{
+		mRows[y] |= 1u << x;
+		mFaces[y][x] = face;
+	}
+
+	return invalid;
+}
+
+//***************************************************************************************
+//
+//	Function:	erase
+//	Purpose:	Removes tetris unit in given location
+//	Return:		True if invalid location for current board metrics
+//
+//***************************************************************************************
+bool cTrisEngine::erase(int x, int y)
+{
+	bool invalid(false);
+
+	if(x < 0 || x >= mxSize || y < 0 || y >= mySize)
+		invalid = true;
+	else
+	{
+		mRows[y] &= ~(1u << x);
+		mFaces[y][x] = EMPTY_FACE;
+	}
+
+	return invalid;
+}
+
+//***************************************************************************************
+//
+//	Function:	sonicLock
+//	Purpose:	Instantaneously drops and locks down tetrad
+//	Return:		True if collision occurs (which it really should)
+//				Cleared line count passed by reference
+//
+//***************************************************************************************
+int cTrisEngine::sonicLock(int &cleared)
+{
+	bool collision(false);
+	cleared = 0;
+
+	if(mActive)
+	{
+		while(!moveDown(cleared))			// Move down until no longer possible
+			dropScore();					// Drop score is doubled for sonic lock
+		collision = true;					// Collision has occurred
+		dropScore();
+	}
+	else
+		collision = -1;
+
+	return collision;
+}
+
+int cTrisEngine::sonicLock(int &cleared, int units[])
+{
+	bool collision(false);
+	cleared = 0;
+
+	if(mActive)
+	{
+		while(!moveDown(cleared, units))	// Move down until no longer possible
+			dropScore();					// Drop score is doubled for sonic lock
+		collision = true;					// Collision has occurred
+		dropScore();
+	}
+	else
+		collision = -1;
+
+	return collision;
+}
+
+//***************************************************************************************
+//
+//	Function:	moveRight
+//	Purpose:	Attempts to move active tetrad right one unit
+//	Return:		Number of lines cleared
+//
+//***************************************************************************************
+int cTrisEngine::moveRight()
+{
+	int collision(false);
+
+	if(mActive)
+	{
+		collision = collides(mActiveTetrad, 1, 0);		// Collision check
+
+		if(!collision)
+			mActiveTetrad.moveRight();
+	}
+	else
+		collision = -1;
+
+	return collision;
+}
+
+//***************************************************************************************
+//
+//	Function:	moveLeft
+//	Purpose:	Attempts to move active tetrad left one unit
+//	Return:		True if unit is unable to move due to collision
+//
+//***************************************************************************************
+int cTrisEngine::moveLeft()
+{
+	int collision(false);
+
+	if(mActive)
+	{
+		collision = collides(mActiveTetrad, -1, 0);	// Collision check
+
+		if(!collision)
+			mActiveTetrad.moveLeft();
+	}
+	else
+		collision = -1;
+
+	return collision;
+}
+
+//***************************************************************************************
+//
+//	Function:	moveDown
+//	Purpose:	Attempts to move active tetrad down one unit
+//				Increases score per unit drop
+//	Return:		Number of cleared lines
+//				Cleared line count passed by reference
+//				Overload returns array of size 12 containing unit data
+//
+//***************************************************************************************
+int cTrisEngine::moveDown(int &cleared)
+{
+	if(mActive)
+		dropScore();
+	return forceDown(cleared);
+}
+
+int cTrisEngine::moveDown(int &cleared, int units[])
+{
+	if(mActive)
+		dropScore();
+	return forceDown(cleared, units);
+}
+
+//***************************************************************************************
+//
+//	Function:	forceDown
+//	Purpose:	Attempts to move active tetrad down one unit
+//	Return:		Number of cleared lines
+//				Cleared line count passed by reference
+//				Overload returns array of size 12 containing unit data
+//
+//***************************************************************************************
+int cTrisEngine::forceDown(int &cleared)
+{
+	int collision(false);
+	cleared = 0;
+
+	if(mActive)
+	{
+		collision = collides(mActiveTetrad, 0, -1);	// Collision check
+
+		if(!collision)
+			mActiveTetrad.moveDown();
+	}
+	else
+	{
+		collision = -1;
+		nextTetrad();
+		if(!mActive)
+			nextTetrad();
+	}
+
+	if(collision > 0)				// If collision occurs, tetrad becomes locked
+	{
+		lockTetrad();				// Lock down this tetrad
+		cleared = clearLines();		// Clear any full lines
+		if(!overflowCheck())		// Check for board overflow
+		{
+			nextTetrad();			// Fire next tetrad
+		}
+		else
+			mGameOver = true;
+	}
+
+	return collision;
+}
+
+int cTrisEngine::forceDown(int &cleared, int units[])
+{
+	int collision(false);
+	cleared = 0;
+
+	if(mActive)
+	{
+		collision = collides(mActiveTetrad, 0, -1);	// Collision check
+
+		if(!collision)
+			mActiveTetrad.moveDown();
+	}
+	else
+	{
+		collision = -1;
+		nextTetrad();
+		if(!mActive)
+			nextTetrad();
+	}
+
+	if(collision > 0)				// If collision occurs, tetrad becomes locked
+	{
+		int n(0);
+
+		for(int i(0); i < 4; i++)
+		{
+			units[n++] = mActiveTetrad.type();
+			units[n++] = mActiveTetrad.x(i);
+			units[n++] = mActiveTetrad.y(i);
+		}
+
+		lockTetrad();				// Lock down this tetrad
+		cleared = clearLines();		// Clear any full lines
+		if(!overflowCheck())		// Check for board overflow
+		{
+			nextTetrad();			// Fire next tetrad
+		}
+		else
+			mGameOver = true;
+	}
+
+	return collision;
+}
+
+//***************************************************************************************
+//
+//	Function:	rotateRight
+//	Purpose:	Attempts to rotate active tetrad left (counterclockwise)
+//	Return:		True if rotation cannot be completed
+//
+//***************************************************************************************
+int cTrisEngine::rotateRight()
+{
+	int collision(0);
+
+	if(mActive)
+	{
+		cTetrad rotated(mActiveTetrad);						// Copy current state
+
+		rotated.rotateRight();								// View rotated tetrad
+
+		collision = collides(rotated, 0, 0);				// Check for collision
+
+		if(!collision)										// If no collision occurs
+			mActiveTetrad = rotated;						// Commit rotation
+	}
+	else
+		collision = -1;
+
+	return collision;
+}
+
+//***************************************************************************************
+//
+//	Function:	rotateLeft
+//	Purpose:	Attempts to rotate active tetrad left (counterclockwise)
+//	Return:		True if rotation cannot be completed
+//
+//***************************************************************************************
+int cTrisEngine::rotateLeft()
+{
+	int collision(0);
+
+	if(mActive)
+	{
+		cTetrad rotated(mActiveTetrad);
+
+		rotated.rotateLeft();
+
+		collision = collides(rotated, 0, 0);
+
+		if(!collision)
+			mActiveTetrad = rotated;
+	}
+	else
+		collision = -1;
+
+	return collision;
+}
+
+//***************************************************************************************
+//
+//	Function:	check
+//	Purpose:	Checks if given coordinate is occupied or off board
+//	Return:		True if location is unavailable
+//
+//***************************************************************************************
+bool cTrisEngine::check(int x, int y)
+{
+	bool collision(false);
+
+	if(x < 0 || x >= mxSize || y < 0 || y >= mySize)
+		collision = true;
+	else if(mRows[y] & (1u << x))
+		collision = true;
+
+	return collision;
+}
+
+//***************************************************************************************
+//
+//	Function:	collides
+//	Purpose:	Checks if given tetrad, offset by given distance, overlaps any
+//				occupied or off board location
+//	Return:		True if tetrad is in collision
+//
+//***************************************************************************************
+bool cTrisEngine::collides(cTetrad &tetrad, int dx, int dy)
+{
+	bool collision(false);
+
+	for(int i(0); i < 4 && !collision; i++)
+		collision = check(tetrad.x(i) + dx, tetrad.y(i) + dy);
+
+	return collision;
+}
+
+//***************************************************************************************
+//
+//	Function:	face
+//	Purpose:	Getter for appearance of unit in given coordinate
+//	Return:		Face of unit; EMPTY_FACE if location is unoccupied or off board
+//
+//***************************************************************************************
+int cTrisEngine::face(int x, int y)
+{
+	int face(EMPTY_FACE);
+
+	if(x >= 0 && x < mxSize && y >= 0 && y < mySize)
+		face = mFaces[y][x];
+
+	return face;
+}
+
+//***************************************************************************************
+//
+//	Function:	lockTetrad
+//	Purpose:	Locks current tetrad in place;
+//				places units from tetrad into playing grid
+//
+//***************************************************************************************
+void cTrisEngine::lockTetrad()
+{
+	for(int i(0); i < 4; i++)	// Place each unit into playing board
+		add(mActiveTetrad.x(i), mActiveTetrad.y(i), mActiveTetrad.type());
+
+	mActive = false;			// Tetrad is no longer in play
+}
+
+//***************************************************************************************
+//
+//	Function:	overflowCheck
+//	Purpose:	Checks if board has overflowed
+//	Return:		True if board has overflowed
+//
+//***************************************************************************************
+bool cTrisEngine::overflowCheck()
+{
+	bool overflow(false);
+
+	if(mRows[mySize - 2] | mRows[mySize - 1])	// If either of top two rows is occupied
+		overflow = true;						// Flag overflow
+
+	return overflow;
+}
+
+//***************************************************************************************
+//
+//	Function:	clearLines
+//	Purpose:	Clears any full lines from playing board, shifts above units down
+//				Full lines are found for the whole board at once; remaining lines
+//				are then compacted downward in a single pass
+//	Return:		Number of lines cleared
+//
+//***************************************************************************************
+int cTrisEngine::clearLines()
+{
+	int lines(0);
+	unsigned int full = fullLines();			// Flags for each full line
+
+	if(full)
+	{
+		int y(0);
+		int target(0);							// Destination of next kept line
+
+		while(!(full & (1u << y)))				// Lines below first full line stay
+			y++;
+
+		for(target = y; y < mySize; y++)		// For each line from there up
+		{
+			if(full & (1u << y))				// If line is full
+				lines++;						// Drop it
+			else								// Else move line down
+			{
+				mRows[target] = mRows[y];
+				memcpy(mFaces[target], mFaces[y], BOARD_MAX_WIDTH);
+				target++;
+			}
+		}
+
+		for(; target < mySize; target++)		// Vacate lines left at top
+			clearLine(target);
+
+		mClears[lines - 1]++;					// Increment appropriate line counter
+
+		lineScore(lines);						// Increase player's score
+		levelCheck(lines);						// Process against rest
+	}
+
+	return lines;
+}
+
+//***************************************************************************************
+//
+//	Function:	levelCheck
+//	Purpose:	Processes lines against remaining line counter; handles levelup
+//
+//***************************************************************************************
+void cTrisEngine::levelCheck(int lines)
+{
+	mRemaining -= lines;
+
+	if(mRemaining < 1)
+	{
+		mRemaining += 10;
+		mLevel++;
+	}
+}
+
+//***************************************************************************************
+//
+//	Function:	fullLines
+//	Purpose:	Checks every line of the board for fullness
+//				With SSE2, compares four rows against the full row mask at a time
+//	Return:		Bitmask with bit y set if line y is full
+//
+//***************************************************************************************
+unsigned int cTrisEngine::fullLines()
+{
+	unsigned int full(0);
+
+#ifdef BT_SSE2
+	__m128i fullRow = _mm_set1_epi32(mFullRow);
+
+	for(int y(0); y < mySize; y += 4)			// For each group of four lines
+	{
+		__m128i rows = _mm_loadu_si128((const __m128i*)(mRows + y));
+		__m128i match = _mm_cmpeq_epi32(rows, fullRow);
+
+		full |= (unsigned int)_mm_movemask_ps(_mm_castsi128_ps(match)) << y;
+	}
+#else
+	for(int y(0); y < mySize; y++)				// For each line
+		if(mRows[y] == mFullRow)
+			full |= 1u << y;
+#endif
+
+	return full;
+}
+
+//***************************************************************************************
+//
+//	Function:	clearLine
+//	Purpose:	Clears units from given line
+//
+//***************************************************************************************
+void cTrisEngine::clearLine(int y)
+{
+	mRows[y] = 0;										// Vacate row
+	memset(mFaces[y], EMPTY_FACE, BOARD_MAX_WIDTH);
+}
+
+//***************************************************************************************
+//
+//	Function:	lineScore
+//	Purpose:	Increases player's score based on clear type and current level
+//				Blue Tetris utilizes the original Tetris scoring functions:
+//				http://www.tetrisconcept.com/wiki/index.php/Scoring
+//
+//				Formulae for score, where n = current game level
+//				1 line:    40 * (n + 1)
+//				2 lines:  100 * (n + 1)
+//				3 lines:  300 * (n + 1)
+//				4 lines: 1200 * (n + 1)
+//
+//***************************************************************************************
+void cTrisEngine::lineScore(const int lines)
+{
+	int base(0);				// Base score (function of clear type)
+
+	if(lines == 1)
+		base = 40;
+	else if(lines == 2)
+		base = 100;
+	else if(lines == 3)
+		base = 300;
+	else if(lines == 4)
+		base = 1200;
+
+	mScore += base * (mLevel + 1);
+}
+
+//***************************************************************************************
+//
+//	Function:	dropScore
+//	Purpose:	Increases player's score per unit of soft drop
+//
+//***************************************************************************************
+void cTrisEngine::dropScore()
+{
+	mScore++;
+}
+
+//***************************************************************************************
+//
+//	Function:	checkWidth
+//	Purpose:	Checks if width is within valid range
+//				Any invalid values are rounded to acceptable values
+//
+//	Returns:	True if value was out of range
+//
+//***************************************************************************************
+bool cTrisEngine::checkWidth()
+{
+	bool invalid(false);
+
+	if(mxSize < 4)
+	{
+		mxSize = 4;
+		invalid = true;
+	}
+	else if(mxSize > 20)
+	{
+		mxSize = 20;
+		invalid = true;
+	}
+
+	return invalid;
+}
+
+//***************************************************************************************
+//
+//	Function:	checkHeight
+//	Purpose:	Checks if height is within valid range
+//				Any invalid values are rounded to acceptable values
+//
+//	Returns:	True if value was out of range
+//
+//***************************************************************************************
+bool cTrisEngine::checkHeight()
+{
+	bool invalid(false);
+
+	if(mySize < 6)
+	{
+		mySize = 6;
+		invalid = true;
+	}
+	else if(mySize > 30)
+	{
+		mySize = 30;
+		invalid = true;
+	}
+
+	return invalid;
+}
+
+//***************************************************************************************
+//
+//	Function:		setWidth
+//	Purpose:		Sets board's width
+//	Return:			True if size is out of bounds
+//
+//***************************************************************************************
+bool cTrisEngine::setWidth(int width)
+{
+	bool valid;
+
+	mxSize = width;
+	valid = checkWidth();
+	initBoard();
+
+	return valid;
+}
+
+//***************************************************************************************
+//
+//	Function:		setHeight
+//	Purpose:		Sets board's height
+//	Return:			True if size is out of bounds
+//
+//***************************************************************************************
+bool cTrisEngine::setHeight(int height)
+{
+	bool valid;
+
+	mySize = height;
+	valid = checkHeight();
+	initBoard();
+
+	return valid;
+}
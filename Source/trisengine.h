@@ -0,0 +1,149 @@
+//***************************************************************************************
+//
+//	Date Created:	October 17, 2026
+//	File:			trisengine.h
+//	Project:		Blue Tetris
+//
+//	Purpose:		Class definition for the Blue Tetris rules engine: playing field,
+//					falling tetrads, scoring and levelling for one player's board.
+//					Has no rendering or operating system dependencies, so it may be
+//					built on its own for the server and for headless tools.
+//
+//***************************************************************************************
+
+#pragma once
+
+// Local defines
+#define BOARDWIDTH	10
+#define BOARDDEPTH	22
+
+#define BOARD_MAX_WIDTH		20	// Board metric limits (see checkWidth, checkHeight)
+#define BOARD_MAX_HEIGHT	30
+#define BOARD_ROW_STORAGE	32	// Row storage, padded to a whole number of vectors
+#define EMPTY_FACE			-1	// Face value of an unoccupied location
+
+// Include
+#include "tetrad.h"
+#include "trisunit.h"
+#include "random.h"
+
+//***************************************************************************************
+//
+//	Class:		cTrisEngine
+//	Purpose:	Represents the game state of one playing board for Blue Tetris
+//
+//***************************************************************************************
+class cTrisEngine
+{
+public:
+	cTrisEngine();								// Constructors
+	cTrisEngine(int columns, int rows, bool permute, int level);
+
+	void clear();								// Clears the board
+	bool remove(int rx, int ry);				// Removes unit in given coord
+
+	bool add(int x, int y, int face);			// Single unit insertion/overwrite
+	bool erase(int x, int y);					// Single unit deletion
+
+	void start();								// Puts playing board in active state
+	int clearLines();							// Clears any full lines
+	void nextTetrad();							// Advances to next tetrad
+
+	int sonicLock(int &cleared);				// Tetrad movement functions
+	int sonicLock(int &cleared, int units[]);
+	int moveDown(int &cleared);
+	int moveDown(int &cleared, int units[]);
+	int forceDown(int &cleared);
+	int forceDown(int &cleared, int units[]);
+	int moveLeft();
+	int moveRight();
+
+	int rotateLeft();							// Rotation function
+	int rotateRight();
+
+	void redraw();
+
+	// Setters
+	bool setWidth(int width);
+	bool setHeight(int height);
+	void setPermutation(bool state) { mPermute = state; }
+	void setNext(int list[]);
+	void setAutonomy(bool state) { mAutonomous = state; }
+	void setTetrad(cTetrad tetrad) { mActiveTetrad = tetrad; mActive = true; }
+	void setSeed(unsigned long long seed) { mRandom.seed(seed); }
+	void setRandom(cRandom random) { mRandom = random; }
+
+	// Getters
+	cTetrad getTetrad() { return mActiveTetrad; }
+	cTetrad* getTetradPtr() { if(mActive) return &mActiveTetrad; else return NULL; }
+	cRandom getRandom() { return mRandom; }		// Generator state, for reproduction
+	cTrisUnit unit(int x, int y) { return cTrisUnit(x, y, face(x, y)); }
+	int face(int x, int y);						// Returns face of unit in location
+	unsigned int row(int y) { if(y >= 0 && y < mySize) return mRows[y]; else return 0; }
+	int getNext(int n) { if(n >=0 && n <= 7) return mTetradList[n]; else return -1; }
+	int preview(int n);							// Type of nth tetrad after active one
+	int width() { return mxSize; }
+	int height() { return mySize; }
+	int level() { return mLevel; }
+	bool permutation() { return mPermute; }
+	int singles() { return mClears[0]; }
+	int doubles() { return mClears[1]; }
+	int triples() { return mClears[2]; }
+	int tetrises() { return mClears[3]; }
+	int remaining() { return mRemaining; }
+	long double score() { return mScore; }
+	bool gameOver() { return mGameOver || overflowCheck(); }
+
+	bool check(int x, int y);					// Checks if location is occupied/OB
+
+protected:
+
+	bool collides(cTetrad &tetrad, int dx, int dy);	// Checks tetrad against board
+	bool overflowCheck();						// Checks for board overflow
+
+	void lineScore(const int lines);			// Increases score upon line clear
+	void dropScore();							// Increases score upon manual drop
+
+	unsigned int fullLines();					// Flags full lines
+	void clearLine(int y);						// Clears units from given line
+	void levelCheck(int lines);					// Handles levelling
+
+	void primeTetrads();						// Initializes tetrads
+	void drawTetrads();							// Draws tetrad sequence
+	void lockTetrad();							// Locks tetrad in place
+	void drawRandomTetrads();					// Draws next tetrads randomly
+
+	void initBoard();							// Initializes playing board data container
+
+	bool checkWidth();							// Verifies that width is in valid range
+	bool checkHeight();							// Verifies that height is in valid range
+
+	cTetrad mActiveTetrad;						// Active tetrad
+	cTetrad mNextTetrad;						// Next tetrad
+	bool mActive;								// Flags presence of active tetrad
+	bool mNext;									// Flags presence of next tetrad
+
+	int mTetradList[7];							// List of next tetrad pieces
+	int mIndex;									// Current location in list
+	cRandom mRandom;							// Draws tetrad lists; seeded per board
+
+	// Playing board: row-major bitboard. Bit x of mRows[y] is set if (x, y) is
+	// occupied; appearance of each occupied location is kept in mFaces.
+	unsigned int mRows[BOARD_ROW_STORAGE];		// Occupancy of each row
+	char mFaces[BOARD_ROW_STORAGE][BOARD_MAX_WIDTH];	// Unit appearance by row
+	unsigned int mFullRow;						// Occupancy of a completely filled row
+	int	mxSize;									// Column count
+	int mySize;									// Row count
+
+	// Game options: functional
+	bool mPermute;								// Toggles tetrad generation method
+
+	bool mAutonomous;							// Flags reliance on server
+
+	// Game info
+	int mLevel;						// Playing level
+	int mClears[4];					// Clear count for each clearing magnitude
+	long double mScore;				// Player's score
+	int mRemaining;					// Remaining lines for this level
+	bool mGameOver;					// Flags game end (board goes idle)
+};
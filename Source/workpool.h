@@ -0,0 +1,201 @@
+//***************************************************************************************
+//
+//	Date Created:	October 17, 2026
+//	File:			workpool.h
+//	Project:		Blue Tetris
+//
+//	Purpose:		Work-stealing thread pool for batches of independent numbered
+//					tasks, such as headless games. Each thread starts with an even
+//					share of the task numbers and takes from the front of its own
+//					share; a thread that runs dry steals the back half of another's.
+//					Shares are a pair of numbers in one atomic word, so no locks
+//					are taken.
+//
+//***************************************************************************************
+
+#pragma once
+
+#include <thread>
+#include <atomic>
+#include <vector>
+#include "ringbuffer.h"
+
+using std::vector;
+
+#define POOL_NOTASK			-1			// take()/steal(): no task found
+
+//***************************************************************************************
+//
+//	Class:		cWorkPool
+//	Purpose:	Runs body(task, thread) once for every task number in [0, count)
+//				across a fixed number of threads, the caller being thread 0
+//
+//***************************************************************************************
+class cWorkPool
+{
+public:
+	cWorkPool(int threads);
+	~cWorkPool() { delete[] mShares; }
+
+	template <class F>
+	void run(int count, F &body);				// Returns when every task is done
+
+	int threads() { return mThreadCount; }
+
+private:
+
+	cWorkPool(const cWorkPool&);				// Not copyable
+	cWorkPool& operator=(const cWorkPool&);
+
+	template <class F>
+	void work(int thread, F* body);				// Thread body
+	int take(int thread);						// Front of own share
+	int steal(int thread);						// Back half of another's share
+
+	static unsigned long long pack(unsigned int begin, unsigned int end)
+		{ return (unsigned long long)begin << 32 | end; }
+
+	// Task numbers [begin, end) not yet taken, kept a cache line apart
+	struct cShare
+	{
+		std::atomic<unsigned long long> mRange;
+		char mPad[RING_PADDING - sizeof(std::atomic<unsigned long long>)];
+	};
+
+	cShare* mShares;							// One per thread
+	int mThreadCount;
+};
+
+//***************************************************************************************
+//
+//	Function:	constructor
+//	Purpose:	Sets thread count; zero or less means one per hardware thread
+//
+//***************************************************************************************
+inline cWorkPool::cWorkPool(int threads): mShares(NULL), mThreadCount(threads)
+{
+	if(mThreadCount < 1)
+		mThreadCount = (int)std::thread::hardware_concurrency();
+	if(mThreadCount < 1)
+		mThreadCount = 1;
+
+	mShares = new cShare[mThreadCount];
+}
+
+//***************************************************************************************
+//
+//	Function:	run
+//	Purpose:	Deals the task numbers out evenly and runs them all. body must be
+//				safe to call from several threads at once.
+//
+//***************************************************************************************
+template <class F>
+void cWorkPool::run(int count, F &body)
+{
+	vector<std::thread> helpers;
+	int t;
+
+	for(t = 0; t < mThreadCount; t++)
+	{
+		unsigned int begin = (unsigned int)((long long)count * t / mThreadCount);
+		unsigned int end = (unsigned int)((long long)count * (t + 1) / mThreadCount);
+		mShares[t].mRange.store(pack(begin, end));
+	}
+
+	for(t = 1; t < mThreadCount; t++)
+		helpers.push_back(std::thread(&cWorkPool::work<F>, this, t, &body));
+
+	work(0, &body);
+
+	for(t = 0; t < (int)helpers.size(); t++)
+		helpers[t].join();
+}
+
+//***************************************************************************************
+//
+//	Function:	work
+//	Purpose:	Runs tasks from own share, then stolen ones, until none are found
+//
+//***************************************************************************************
+template <class F>
+void cWorkPool::work(int thread, F* body)
+{
+	int task;
+
+	for(;;)
+	{
+		task = take(thread);
+		if(task == POOL_NOTASK)
+			task = steal(thread);
+		if(task == POOL_NOTASK)
+			return;
+
+		(*body)(task, thread);
+	}
+}
+
+//***************************************************************************************
+//
+//	Function:	take
+//	Purpose:	Removes first task number from the thread's own share
+//	Return:		Task number; POOL_NOTASK if share is empty
+//
+//***************************************************************************************
+inline int cWorkPool::take(int thread)
+{
+	std::atomic<unsigned long long> &range = mShares[thread].mRange;
+	unsigned long long current = range.load();
+	unsigned int begin, end;
+
+	do
+	{
+		begin = (unsigned int)(current >> 32);
+		end = (unsigned int)current;
+
+		if(begin >= end)
+			return POOL_NOTASK;
+	}
+	while(!range.compare_exchange_weak(current, pack(begin + 1, end)));
+
+	return (int)begin;
+}
+
+//***************************************************************************************
+//
+//	Function:	steal
+//	Purpose:	Takes the back half of the first non-empty share after the
+//				thread's own, runs its first task and keeps the rest as its own
+//				share. Task numbers are never reused, so a share cannot return to
+//				a range a thief last saw.
+//	Return:		Task number; POOL_NOTASK if every share is empty
+//
+//***************************************************************************************
+inline int cWorkPool::steal(int thread)
+{
+	unsigned long long current;
+	unsigned int begin, end, half;
+
+	for(int i(1); i < mThreadCount; i++)
+	{
+		std::atomic<unsigned long long> &range = mShares[(thread + i) % mThreadCount].mRange;
+		current = range.load();
+
+		for(;;)
+		{
+			begin = (unsigned int)(current >> 32);
+			end = (unsigned int)current;
+
+			if(begin >= end)
+				break;
+
+			half = (end - begin + 1) / 2;		// At least one task
+			if(range.compare_exchange_weak(current, pack(begin, end - half)))
+			{
+				mShares[thread].mRange.store(pack(end - half + 1, end));
+				return (int)(end - half);
+			}
+		}
+	}
+
+	return POOL_NOTASK;
+}